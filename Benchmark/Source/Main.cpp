@@ -0,0 +1,831 @@
+#include <JuceHeader.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include "../../Source/Crossover.h"
+#include "../../Source/PartitionedConvolver.h"
+#include "../../Source/PluginProcessor.h"
+
+// Headless benchmark for SkuxAudioProcessor. Drives processBlock over a grid
+// of block sizes, sample rates and parameter settings and prints one JSON
+// document, so results can be diffed and gated between releases.
+//
+//   SkuxBenchmark [--block-sizes=16,64,...] [--sample-rates=44100,...]
+//                 [--seconds=1] [--input=a.wav,b.flac] [--output=results.json]
+//                 [--quick] [--sub-block=64] [--multi-pass] [--verify]
+//                 [--double] [--mid-side] [--quality=eco|normal|high]
+//
+// Besides the grid over routing, Type and Mix, every block size also runs
+// the 2, 3 and 4 band multiband path, and the cabinet on a synthetic
+// response.
+//
+// --sub-block sets the processor's internal sub-block size; --multi-pass
+// times the one-pass-per-stage reference path instead. --verify adds the
+// largest sample difference between the two paths to every result, plus
+// how far the multiband path at zero mix is from a plain allpass chain, the
+// vectorised clip kernels from their scalar reference, the partitioned
+// convolver from direct convolution and the parameters each preset selects
+// from the values it holds. Checks with a limit exit with status 2 when one
+// is over it.
+// --double runs the 64-bit processBlock.
+// --mid-side runs every case in Mid/Side mode with separate side values.
+// --quality pins the Quality setting; Auto is left out as it follows load.
+
+namespace
+{
+  std::atomic<bool> countAllocations { false };
+  std::atomic<juce::int64> allocationCount { 0 };
+
+  void* allocate(std::size_t size)
+  {
+    if (countAllocations.load(std::memory_order_relaxed))
+      allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+      return ptr;
+
+    throw std::bad_alloc();
+  }
+
+  // Over-aligned types, such as SIMDRegister state, come through here. The
+  // pointer malloc returned is kept just below the aligned block, as there
+  // is no aligned allocation every platform's runtime shares.
+  void* allocate(std::size_t size, std::align_val_t alignment)
+  {
+    const auto align = juce::jmax(static_cast<std::size_t>(alignment), sizeof(void*));
+    auto* raw = static_cast<char*>(allocate(size + align + sizeof(void*)));
+    const auto address = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + align - 1) & ~(align - 1);
+
+    auto* ptr = reinterpret_cast<void**>(address);
+    ptr[-1] = raw;
+    return ptr;
+  }
+
+  void deallocateAligned(void* ptr)
+  {
+    if (ptr != nullptr)
+      std::free(static_cast<void**>(ptr)[-1]);
+  }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocateAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { deallocateAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { deallocateAligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { deallocateAligned(ptr); }
+
+namespace
+{
+  struct Signal
+  {
+    juce::String name;
+    juce::AudioBuffer<float> audio;
+  };
+
+  struct BenchmarkCase
+  {
+    int blockSize;
+    double sampleRate;
+    int routing;
+    int clipType;
+    float mix;
+    int subBlockSize;
+    bool multiPass;
+    bool doublePrecision;
+    bool midSide;
+    int quality;
+    int numBands = 1;
+    // Impulse response for the Cabinet stage; none leaves it off.
+    juce::File cabinet {};
+  };
+
+  struct BenchmarkResult
+  {
+    double nsPerSample = 0.0;
+    double blockP50Ns = 0.0;
+    double blockP99Ns = 0.0;
+    double allocationsPerBlock = 0.0;
+  };
+
+  juce::Array<int> parseIntList(const juce::String& text)
+  {
+    juce::Array<int> values;
+
+    for (const auto& token : juce::StringArray::fromTokens(text, ",", {}))
+      values.add(token.trim().getIntValue());
+
+    return values;
+  }
+
+  Signal makeSweep(double sampleRate, int numSamples)
+  {
+    Signal signal { "sweep", juce::AudioBuffer<float>(2, numSamples) };
+
+    // Exponential sine sweep from 20 Hz to 20 kHz at -6 dBFS.
+    const auto duration = numSamples / sampleRate;
+    const auto rate = std::log(20000.0 / 20.0);
+
+    for (int s = 0; s < numSamples; ++s) {
+      const auto t = s / sampleRate;
+      const auto phase = juce::MathConstants<double>::twoPi * 20.0 * duration / rate
+                         * (std::exp(t * rate / duration) - 1.0);
+      const auto value = static_cast<float>(0.5 * std::sin(phase));
+
+      signal.audio.setSample(0, s, value);
+      signal.audio.setSample(1, s, value);
+    }
+
+    return signal;
+  }
+
+  // Noise decaying by 60 dB over the length, roughly how a cabinet rings.
+  std::vector<float> makeImpulse(int length)
+  {
+    std::vector<float> impulse(static_cast<size_t>(length));
+    juce::Random random(2);
+
+    for (int i = 0; i < length; ++i)
+      impulse[static_cast<size_t>(i)] = (random.nextFloat() - 0.5f)
+                                        * std::pow(0.001f, static_cast<float>(i) / static_cast<float>(length));
+
+    return impulse;
+  }
+
+  bool writeImpulse(const juce::File& file, double sampleRate, int length)
+  {
+    const auto impulse = makeImpulse(length);
+    file.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+    if (stream == nullptr)
+      return false;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+      juce::WavAudioFormat().createWriterFor(stream.get(), sampleRate, 1, 32, {}, 0));
+    if (writer == nullptr)
+      return false;
+
+    stream.release();
+    const float* channels[] = { impulse.data() };
+    return writer->writeFromFloatArrays(channels, 1, length);
+  }
+
+  Signal makeNoise(int numSamples)
+  {
+    Signal signal { "noise", juce::AudioBuffer<float>(2, numSamples) };
+    juce::Random random(1);
+
+    for (int ch = 0; ch < 2; ++ch) {
+      for (int s = 0; s < numSamples; ++s)
+        signal.audio.setSample(ch, s, random.nextFloat() - 0.5f);
+    }
+
+    return signal;
+  }
+
+  bool loadRecording(const juce::File& file, Signal& signal)
+  {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr)
+      return false;
+
+    const auto numSamples = static_cast<int>(reader->lengthInSamples);
+
+    signal.name = file.getFileName();
+    signal.audio.setSize(2, numSamples);
+    reader->read(&signal.audio, 0, numSamples, 0, true, true);
+    return numSamples > 0;
+  }
+
+  int numVerifyFailures = 0;
+
+  // Reports an error that is over its limit and counts it against the run.
+  double checkError(const juce::String& name, double error, double limit)
+  {
+    if (! (error <= limit)) {
+      std::cerr << "FAILED " << name << ": " << error << " > " << limit << std::endl;
+      ++numVerifyFailures;
+    }
+
+    return error;
+  }
+
+  void setParameter(SkuxAudioProcessor& processor, const juce::String& id, float value)
+  {
+    auto* parameter = processor.apvts.getParameter(id);
+    jassert(parameter != nullptr);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+  }
+
+  juce::String getChoiceName(SkuxAudioProcessor& processor, const juce::String& id, int index)
+  {
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(processor.apvts.getParameter(id)))
+      return choice->choices[index];
+
+    return juce::String(index);
+  }
+
+  void prepareProcessor(SkuxAudioProcessor& processor, const BenchmarkCase& benchmarkCase)
+  {
+    setParameter(processor, "Filter Routing", static_cast<float>(benchmarkCase.routing));
+    setParameter(processor, "Type", static_cast<float>(benchmarkCase.clipType));
+    setParameter(processor, "Mix", benchmarkCase.mix);
+    setParameter(processor, "Drive", 6.f);
+    setParameter(processor, "Filter Cutoff", 800.f);
+
+    if (benchmarkCase.midSide) {
+      setParameter(processor, "Stereo Mode", 1.f);
+      setParameter(processor, "Side Values", 1.f);
+      setParameter(processor, "Side Drive", 3.f);
+      setParameter(processor, "Side Mix", benchmarkCase.mix);
+      setParameter(processor, "Side Cutoff", 2000.f);
+    }
+
+    setParameter(processor, "Multiband", static_cast<float>(benchmarkCase.numBands - 1));
+
+    // Alternating curves, so the mixed soft/hard lane kernel is measured.
+    for (int b = 0; b < benchmarkCase.numBands; ++b) {
+      const auto prefix = "Band " + juce::String(b + 1) + " ";
+      setParameter(processor, prefix + "Drive", 6.f);
+      setParameter(processor, prefix + "Mix", benchmarkCase.mix);
+      setParameter(processor, prefix + "Type", static_cast<float>(b % 2));
+    }
+
+    if (benchmarkCase.cabinet != juce::File())
+      processor.getCabinet().load(benchmarkCase.cabinet);
+
+    setParameter(processor, "Cabinet", benchmarkCase.cabinet != juce::File() ? 1.f : 0.f);
+    setParameter(processor, "Quality", static_cast<float>(benchmarkCase.quality));
+    processor.setSubBlockSize(benchmarkCase.subBlockSize);
+    processor.setMultiPassProcessing(benchmarkCase.multiPass);
+    processor.setProcessingPrecision(benchmarkCase.doublePrecision
+                                       ? juce::AudioProcessor::doublePrecision
+                                       : juce::AudioProcessor::singlePrecision);
+    processor.setPlayConfigDetails(2, 2, benchmarkCase.sampleRate, benchmarkCase.blockSize);
+    processor.prepareToPlay(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+  }
+
+  template <typename SampleType>
+  void copySignal(const Signal& signal, juce::AudioBuffer<SampleType>& block, int& readPosition)
+  {
+    const auto numSignalSamples = signal.audio.getNumSamples();
+
+    for (int s = 0; s < block.getNumSamples(); ++s) {
+      for (int ch = 0; ch < 2; ++ch)
+        block.setSample(ch, s, static_cast<SampleType>(signal.audio.getSample(ch, readPosition)));
+
+      readPosition = (readPosition + 1) % numSignalSamples;
+    }
+  }
+
+  // Runs the sub-block and multi-pass paths side by side over the same input.
+  template <typename SampleType>
+  double measureSubBlockError(BenchmarkCase benchmarkCase, const Signal& signal, double seconds)
+  {
+    SkuxAudioProcessor sliced, whole;
+    benchmarkCase.multiPass = false;
+    prepareProcessor(sliced, benchmarkCase);
+    benchmarkCase.multiPass = true;
+    prepareProcessor(whole, benchmarkCase);
+
+    juce::AudioBuffer<SampleType> slicedBlock(2, benchmarkCase.blockSize);
+    juce::AudioBuffer<SampleType> wholeBlock(2, benchmarkCase.blockSize);
+    juce::MidiBuffer midi;
+
+    const auto numBlocks = juce::jmax(8, static_cast<int>(seconds * benchmarkCase.sampleRate)
+                                          / benchmarkCase.blockSize);
+    auto maxError = 0.0;
+    int readPosition = 0;
+
+    for (int b = 0; b < numBlocks; ++b) {
+      copySignal(signal, slicedBlock, readPosition);
+      wholeBlock.makeCopyOf(slicedBlock, true);
+
+      sliced.processBlock(slicedBlock, midi);
+      whole.processBlock(wholeBlock, midi);
+
+      for (int ch = 0; ch < 2; ++ch)
+        for (int s = 0; s < benchmarkCase.blockSize; ++s)
+          maxError = juce::jmax(maxError, static_cast<double>(std::abs(slicedBlock.getSample(ch, s)
+                                                                       - wholeBlock.getSample(ch, s))));
+    }
+
+    return maxError;
+  }
+
+  // At zero mix every band is dry, so the multiband path should come out as
+  // the input through one allpass per crossover frequency; the difference to
+  // that chain is the null error. Blocks vary in length like the SIMD check.
+  template <typename SampleType>
+  double measureMultibandError(int numBands, double sampleRate, const Signal& signal)
+  {
+    using LRFilter = juce::dsp::LinkwitzRileyFilter<SampleType>;
+
+    constexpr int maxBlockSize = 512;
+    const typename Crossover<SampleType>::Frequencies frequencies { 5000.f, 200.f, 1000.f };
+    const juce::dsp::ProcessSpec spec { sampleRate, maxBlockSize, 2 };
+    const StereoParameters stereo;
+
+    MultibandParameters bands;
+    bands.numBands = numBands;
+    bands.crossovers = frequencies;
+
+    for (int b = 0; b < numBands; ++b) {
+      const auto band = static_cast<size_t>(b);
+      bands.drive[band] = ParameterRamp { 6.f };
+      bands.mix[band] = ParameterRamp { 0.f };
+      bands.clipType[band] = b % 2;
+    }
+
+    Distortion<SampleType> distortion;
+    distortion.prepare(spec);
+
+    std::array<LRFilter, Crossover<SampleType>::MaxBands - 1> allpasses;
+
+    for (int i = 0; i < numBands - 1; ++i) {
+      auto& allpass = allpasses[static_cast<size_t>(i)];
+      allpass.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+      allpass.prepare(spec);
+      allpass.setCutoffFrequency(static_cast<SampleType>(frequencies[static_cast<size_t>(i)]));
+    }
+
+    juce::AudioBuffer<SampleType> buffer(2, maxBlockSize);
+    auto maxError = 0.0;
+    int readPosition = 0;
+
+    for (int b = 0; readPosition + maxBlockSize < signal.audio.getNumSamples(); ++b) {
+      const auto numSamples = maxBlockSize - (b * 7) % 64;
+
+      for (int ch = 0; ch < 2; ++ch)
+        for (int s = 0; s < numSamples; ++s)
+          buffer.setSample(ch, s, static_cast<SampleType>(signal.audio.getSample(ch, readPosition + s)));
+
+      auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubBlock(0, static_cast<size_t>(numSamples));
+      distortion.processMultiband(block, bands, stereo, b == 0);
+
+      for (int ch = 0; ch < 2; ++ch) {
+        for (int s = 0; s < numSamples; ++s) {
+          auto expected = static_cast<SampleType>(signal.audio.getSample(ch, readPosition + s));
+
+          for (int i = 0; i < numBands - 1; ++i)
+            expected = allpasses[static_cast<size_t>(i)].processSample(ch, expected);
+
+          maxError = juce::jmax(maxError, static_cast<double>(std::abs(buffer.getSample(ch, s) - expected)));
+        }
+      }
+
+      readPosition += numSamples;
+    }
+
+    return maxError;
+  }
+
+  // Runs the plain clip kernels next to Distortion::processScalar. Blocks
+  // start one sample in and vary in length, so the unaligned head, the
+  // registers and the scalar tail all get their share.
+  template <typename SampleType>
+  double measureSIMDError(int clipType, Quality::Level quality, double sampleRate, const Signal& signal)
+  {
+    constexpr int maxBlockSize = 512;
+    const juce::dsp::ProcessSpec spec { sampleRate, maxBlockSize, 2 };
+    const StereoParameters stereo;
+    const auto drive = 6.f;
+    const auto mix = 0.7f;
+
+    Distortion<SampleType> vectorised, scalar;
+    vectorised.prepare(spec);
+    scalar.prepare(spec);
+    vectorised.setQuality(quality);
+    scalar.setQuality(quality);
+
+    juce::AudioBuffer<SampleType> vectorisedBuffer(2, maxBlockSize + 1);
+    juce::AudioBuffer<SampleType> scalarBuffer(2, maxBlockSize + 1);
+    auto maxError = 0.0;
+    int readPosition = 0;
+
+    for (int b = 0; readPosition + maxBlockSize < signal.audio.getNumSamples(); ++b) {
+      const auto numSamples = maxBlockSize - (b * 7) % 64;
+
+      for (int ch = 0; ch < 2; ++ch) {
+        for (int s = 0; s < numSamples; ++s)
+          vectorisedBuffer.setSample(ch, s + 1,
+                                     static_cast<SampleType>(signal.audio.getSample(ch, readPosition + s)));
+      }
+
+      scalarBuffer.makeCopyOf(vectorisedBuffer, true);
+      readPosition += numSamples;
+
+      const auto length = static_cast<size_t>(numSamples);
+      auto vectorisedBlock = juce::dsp::AudioBlock<SampleType>(vectorisedBuffer).getSubBlock(1, length);
+      auto scalarBlock = juce::dsp::AudioBlock<SampleType>(scalarBuffer).getSubBlock(1, length);
+
+      vectorised.process(vectorisedBlock, ParameterRamp { drive }, ParameterRamp { mix }, clipType, stereo,
+                         b == 0);
+      scalar.processScalar(scalarBlock, drive, mix, clipType);
+
+      for (int ch = 0; ch < 2; ++ch)
+        for (int s = 1; s <= numSamples; ++s)
+          maxError = juce::jmax(maxError, static_cast<double>(std::abs(vectorisedBuffer.getSample(ch, s)
+                                                                       - scalarBuffer.getSample(ch, s))));
+    }
+
+    return maxError;
+  }
+
+  // Runs PartitionedConvolver over host blocks of blockSize and returns how
+  // far it lands from direct convolution with the same response.
+  double measureConvolverError(int length, int blockSize, const Signal& signal,
+                               const std::vector<float>& impulse, const juce::AudioBuffer<float>& expected)
+  {
+    PartitionedConvolver convolver(impulse.data(), length, 2);
+    juce::AudioBuffer<float> buffer(signal.audio);
+    const auto numSamples = buffer.getNumSamples();
+    auto maxError = 0.0;
+
+    for (int start = 0; start < numSamples; start += blockSize) {
+      float* channels[] = { buffer.getWritePointer(0, start), buffer.getWritePointer(1, start) };
+      convolver.process(channels, 2, juce::jmin(blockSize, numSamples - start));
+    }
+
+    for (int ch = 0; ch < 2; ++ch)
+      for (int s = 0; s < numSamples; ++s)
+        maxError = juce::jmax(maxError, static_cast<double>(std::abs(buffer.getSample(ch, s)
+                                                                     - expected.getSample(ch, s))));
+
+    return maxError;
+  }
+
+  juce::AudioBuffer<float> convolveDirect(const Signal& signal, const std::vector<float>& impulse)
+  {
+    const auto numSamples = signal.audio.getNumSamples();
+    const auto length = static_cast<int>(impulse.size());
+    juce::AudioBuffer<float> output(2, numSamples);
+
+    for (int ch = 0; ch < 2; ++ch) {
+      const auto* input = signal.audio.getReadPointer(ch);
+
+      for (int s = 0; s < numSamples; ++s) {
+        auto sum = 0.0;
+        for (int i = 0; i < juce::jmin(length, s + 1); ++i)
+          sum += static_cast<double>(impulse[static_cast<size_t>(i)]) * input[s - i];
+
+        output.setSample(ch, s, static_cast<float>(sum));
+      }
+    }
+
+    return output;
+  }
+
+  // Saves a user preset, round-trips the bank through the plugin state and
+  // selects every preset in turn, measuring how far the parameters land from
+  // the values the bank holds. Only rounding in the parameters' range
+  // conversions should separate them; a lost or renamed preset counts as 1.
+  double measurePresetError()
+  {
+    SkuxAudioProcessor original;
+    setParameter(original, "Drive", 7.5f);
+    setParameter(original, "Type", 3.f);
+    setParameter(original, "Filter Cutoff", 2500.f);
+    setParameter(original, "Multiband", 1.f);
+    original.getPresetBank().addCurrent("Verify");
+
+    juce::MemoryBlock state;
+    original.getStateInformation(state);
+
+    SkuxAudioProcessor restored;
+    restored.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+    auto& bank = restored.getPresetBank();
+    const auto numPresets = bank.getNumPresets();
+
+    if (numPresets != original.getPresetBank().getNumPresets())
+      return 1.0;
+
+    const ParameterState parameters(restored.apvts);
+    auto maxError = 0.0;
+
+    for (int i = 0; i < numPresets; ++i) {
+      if (bank.getName(i) != original.getPresetBank().getName(i))
+        return 1.0;
+
+      // Coming from another preset, so every value it sets has to move.
+      bank.select((i + 1) % numPresets);
+      bank.select(i);
+
+      const auto values = parameters.capture();
+      const auto& expected = bank.getValues(i);
+
+      for (size_t p = 0; p < values.size(); ++p)
+        maxError = juce::jmax(maxError, static_cast<double>(std::abs(values[p] - expected[p])));
+    }
+
+    return maxError;
+  }
+
+  template <typename SampleType>
+  BenchmarkResult runCase(const BenchmarkCase& benchmarkCase, const Signal& signal, double seconds)
+  {
+    SkuxAudioProcessor processor;
+    prepareProcessor(processor, benchmarkCase);
+
+    juce::AudioBuffer<SampleType> block(2, benchmarkCase.blockSize);
+    juce::MidiBuffer midi;
+
+    const auto numBlocks = juce::jmax(8, static_cast<int>(seconds * benchmarkCase.sampleRate)
+                                          / benchmarkCase.blockSize);
+    const auto numWarmUpBlocks = juce::jmin(16, numBlocks / 4);
+
+    std::vector<double> blockTimes;
+    blockTimes.reserve(static_cast<size_t>(numBlocks));
+
+    juce::int64 allocations = 0;
+    int readPosition = 0;
+
+    for (int b = 0; b < numWarmUpBlocks + numBlocks; ++b) {
+      copySignal(signal, block, readPosition);
+
+      const auto isMeasured = b >= numWarmUpBlocks;
+
+      allocationCount.store(0);
+      countAllocations.store(isMeasured);
+
+      const auto start = std::chrono::steady_clock::now();
+      processor.processBlock(block, midi);
+      const auto end = std::chrono::steady_clock::now();
+
+      countAllocations.store(false);
+
+      if (isMeasured) {
+        blockTimes.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        allocations += allocationCount.load();
+      }
+    }
+
+    processor.releaseResources();
+
+    BenchmarkResult result;
+    const auto totalNs = std::accumulate(blockTimes.begin(), blockTimes.end(), 0.0);
+
+    result.nsPerSample = totalNs / (static_cast<double>(blockTimes.size()) * benchmarkCase.blockSize);
+    result.allocationsPerBlock = static_cast<double>(allocations) / static_cast<double>(blockTimes.size());
+
+    std::sort(blockTimes.begin(), blockTimes.end());
+    const auto percentile = [&blockTimes](double p) {
+      const auto index = static_cast<size_t>(p * static_cast<double>(blockTimes.size() - 1));
+      return blockTimes[index];
+    };
+
+    result.blockP50Ns = percentile(0.5);
+    result.blockP99Ns = percentile(0.99);
+    return result;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  const auto quick = args.containsOption("--quick");
+  const auto subBlockSize = args.containsOption("--sub-block")
+                              ? args.getValueForOption("--sub-block").getIntValue()
+                              : SkuxAudioProcessor::DefaultSubBlockSize;
+  const auto multiPass = args.containsOption("--multi-pass");
+  const auto verify = args.containsOption("--verify");
+  const auto doublePrecision = args.containsOption("--double");
+  const auto midSide = args.containsOption("--mid-side");
+  const auto quality = args.containsOption("--quality")
+                         ? juce::jmax(0, juce::StringArray { "eco", "normal", "high" }
+                                           .indexOf(args.getValueForOption("--quality").toLowerCase()))
+                         : static_cast<int>(Quality::normal);
+
+  auto blockSizes = quick ? juce::Array<int> { 64, 512 }
+                          : juce::Array<int> { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+  auto sampleRates = quick ? juce::Array<int> { 48000 }
+                           : juce::Array<int> { 44100, 48000, 96000, 192000 };
+  const juce::Array<float> mixValues { 0.f, 0.5f, 1.f };
+
+  if (args.containsOption("--block-sizes"))
+    blockSizes = parseIntList(args.getValueForOption("--block-sizes"));
+
+  if (args.containsOption("--sample-rates"))
+    sampleRates = parseIntList(args.getValueForOption("--sample-rates"));
+
+  const auto seconds = args.containsOption("--seconds")
+                         ? args.getValueForOption("--seconds").getDoubleValue()
+                         : (quick ? 0.25 : 1.0);
+
+  std::vector<Signal> recordings;
+
+  if (args.containsOption("--input")) {
+    for (const auto& path : juce::StringArray::fromTokens(args.getValueForOption("--input"), ",", {})) {
+      Signal recording;
+
+      if (! loadRecording(juce::File::getCurrentWorkingDirectory().getChildFile(path), recording)) {
+        std::cerr << "Could not read " << path << std::endl;
+        return 1;
+      }
+
+      recordings.push_back(std::move(recording));
+    }
+  }
+
+  SkuxAudioProcessor reference;
+  const auto numClipTypes = dynamic_cast<juce::AudioParameterChoice*>(
+                              reference.apvts.getParameter("Type"))->choices.size();
+
+  juce::Array<juce::var> results;
+  juce::Array<juce::var> crossoverResults;
+  juce::Array<juce::var> simdResults;
+  juce::Array<juce::var> convolverResults;
+  auto presetError = 0.0;
+
+  if (verify) {
+    presetError = checkError("Preset recall", measurePresetError(), 1.0e-6);
+
+    // Lengths either side of where the head and each segment size end, and
+    // one running well into the largest partitions.
+    for (const auto length : { 100, 129, 600, 2100, 8300, 20000 }) {
+      const auto impulse = makeImpulse(length);
+      const auto signal = makeNoise(length + 4 * PartitionedConvolver::MaxPartitionSize);
+      const auto expected = convolveDirect(signal, impulse);
+
+      for (const auto blockSize : { 1, 37, 113, 509 }) {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("length", length);
+        entry->setProperty("blockSize", blockSize);
+        entry->setProperty("convolverMaxError",
+                           checkError("Convolver, " + juce::String(length) + " taps in blocks of "
+                                        + juce::String(blockSize),
+                                      measureConvolverError(length, blockSize, signal, impulse, expected),
+                                      1.0e-4));
+        convolverResults.add(juce::var(entry));
+      }
+    }
+  }
+
+  // Written per sample rate, so the cabinet does not resample it.
+  juce::TemporaryFile cabinetFile(".wav");
+
+  for (const auto sampleRate : sampleRates) {
+    std::vector<Signal> signals;
+    signals.push_back(makeSweep(sampleRate, sampleRate * 2));
+    signals.push_back(makeNoise(sampleRate * 2));
+
+    for (const auto& recording : recordings) {
+      Signal copy { recording.name, recording.audio };
+      signals.push_back(std::move(copy));
+    }
+
+    const auto cabinet = writeImpulse(cabinetFile.getFile(), sampleRate, sampleRate / 2)
+                           ? cabinetFile.getFile()
+                           : juce::File();
+
+    if (verify) {
+      for (int numBands = 2; numBands <= Crossover<float>::MaxBands; ++numBands) {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("sampleRate", sampleRate);
+        entry->setProperty("bands", numBands);
+        const auto error = doublePrecision ? measureMultibandError<double>(numBands, sampleRate, signals[1])
+                                           : measureMultibandError<float>(numBands, sampleRate, signals[1]);
+        entry->setProperty("crossoverNullError",
+                           checkError("Multiband null, " + juce::String(numBands) + " bands at "
+                                        + juce::String(sampleRate),
+                                      error, doublePrecision ? 1.0e-9 : 1.0e-4));
+        crossoverResults.add(juce::var(entry));
+      }
+
+      // Plain Soft Clip at every quality level, then Hard Clip.
+      for (int kernel = 0; kernel <= Quality::NumLevels; ++kernel) {
+        const auto clipType = kernel < Quality::NumLevels ? 0 : 1;
+        const auto level = kernel < Quality::NumLevels ? static_cast<Quality::Level>(kernel) : Quality::normal;
+        const auto name = getChoiceName(reference, "Type", clipType)
+                          + (clipType == 0 ? " " + getChoiceName(reference, "Quality", level) : juce::String());
+        const auto error = doublePrecision ? measureSIMDError<double>(clipType, level, sampleRate, signals[1])
+                                           : measureSIMDError<float>(clipType, level, sampleRate, signals[1]);
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("sampleRate", sampleRate);
+        entry->setProperty("kernel", name);
+        entry->setProperty("simdMaxError",
+                           checkError("SIMD " + name + " at " + juce::String(sampleRate), error,
+                                      doublePrecision ? 1.0e-12 : 1.0e-5));
+        simdResults.add(juce::var(entry));
+      }
+    }
+
+    const auto addResult = [&](const Signal& signal, const BenchmarkCase& benchmarkCase) {
+      const auto result = doublePrecision ? runCase<double>(benchmarkCase, signal, seconds)
+                                          : runCase<float>(benchmarkCase, signal, seconds);
+
+      auto* entry = new juce::DynamicObject();
+      entry->setProperty("signal", signal.name);
+      entry->setProperty("sampleRate", sampleRate);
+      entry->setProperty("blockSize", benchmarkCase.blockSize);
+      entry->setProperty("routing", getChoiceName(reference, "Filter Routing", benchmarkCase.routing));
+      entry->setProperty("type", getChoiceName(reference, "Type", benchmarkCase.clipType));
+      entry->setProperty("mix", benchmarkCase.mix);
+      entry->setProperty("multiband", getChoiceName(reference, "Multiband", benchmarkCase.numBands - 1));
+      entry->setProperty("cabinet", benchmarkCase.cabinet != juce::File());
+      entry->setProperty("nsPerSample", result.nsPerSample);
+      entry->setProperty("blockP50Ns", result.blockP50Ns);
+      entry->setProperty("blockP99Ns", result.blockP99Ns);
+      entry->setProperty("allocationsPerBlock", result.allocationsPerBlock);
+
+      // Every stage keeps its state per sample, so moving the sub-block
+      // boundaries only moves which samples fall in a vector kernel's scalar
+      // tail: the two paths may differ by what the SIMD check allows, plus
+      // what the filters make of it.
+      if (verify) {
+        const auto error = doublePrecision ? measureSubBlockError<double>(benchmarkCase, signal, seconds)
+                                           : measureSubBlockError<float>(benchmarkCase, signal, seconds);
+        entry->setProperty("subBlockMaxError",
+                           checkError("Sub-block, " + signal.name + ", "
+                                        + entry->getProperty("routing").toString() + ", "
+                                        + entry->getProperty("type").toString() + " at mix "
+                                        + juce::String(benchmarkCase.mix) + " in blocks of "
+                                        + juce::String(benchmarkCase.blockSize) + " at "
+                                        + juce::String(sampleRate),
+                                      error, doublePrecision ? 1.0e-9 : 1.0e-5));
+      }
+
+      results.add(juce::var(entry));
+    };
+
+    for (const auto& signal : signals) {
+      for (const auto blockSize : blockSizes) {
+        for (int routing = 0; routing < 3; ++routing) {
+          for (int clipType = 0; clipType < numClipTypes; ++clipType) {
+            for (const auto mix : mixValues) {
+              addResult(signal, { blockSize, static_cast<double>(sampleRate), routing, clipType, mix,
+                                  subBlockSize, multiPass, doublePrecision, midSide, quality });
+            }
+          }
+        }
+
+        // The band settings stand in for Type, so only Mix varies here.
+        for (int numBands = 2; numBands <= MultibandParameters::MaxBands; ++numBands) {
+          for (const auto mix : mixValues) {
+            addResult(signal, { blockSize, static_cast<double>(sampleRate), 0, 0, mix,
+                                subBlockSize, multiPass, doublePrecision, midSide, quality, numBands });
+          }
+        }
+
+        if (cabinet != juce::File())
+          addResult(signal, { blockSize, static_cast<double>(sampleRate), 0, 0, 1.f,
+                              subBlockSize, multiPass, doublePrecision, midSide, quality, 1, cabinet });
+      }
+    }
+  }
+
+  auto* document = new juce::DynamicObject();
+  document->setProperty("plugin", JucePlugin_Name);
+  document->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+  document->setProperty("cpu", juce::SystemStats::getCpuModel());
+#if JUCE_DEBUG
+  document->setProperty("debugBuild", true);
+#else
+  document->setProperty("debugBuild", false);
+#endif
+  document->setProperty("secondsPerCase", seconds);
+  document->setProperty("subBlockSize", subBlockSize);
+  document->setProperty("multiPass", multiPass);
+  document->setProperty("doublePrecision", doublePrecision);
+  document->setProperty("midSide", midSide);
+  document->setProperty("quality", getChoiceName(reference, "Quality", quality));
+  document->setProperty("results", results);
+
+  if (verify) {
+    document->setProperty("crossover", crossoverResults);
+    document->setProperty("simd", simdResults);
+    document->setProperty("convolver", convolverResults);
+    document->setProperty("presetMaxError", presetError);
+  }
+
+  const auto json = juce::JSON::toString(juce::var(document));
+
+  if (args.containsOption("--output")) {
+    const auto file = juce::File::getCurrentWorkingDirectory()
+                        .getChildFile(args.getValueForOption("--output"));
+
+    if (! file.replaceWithText(json)) {
+      std::cerr << "Could not write " << file.getFullPathName() << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  return numVerifyFailures > 0 ? 2 : 0;
+}
@@ -0,0 +1,487 @@
+#include <JuceHeader.h>
+#include <iostream>
+#include <map>
+#include "../../Source/PluginProcessor.h"
+
+// Offline renderer: streams audio files through SkuxAudioProcessor on a
+// thread pool and writes the results next to each other in one folder.
+//
+//   skux-render --output-dir=out [--state=preset.bin]
+//               [--params="Drive=12,Type=Hard Clip,Mix=0.8"]
+//               [--format=wav|flac] [--threads=N] [--block-size=512]
+//               [--chunk-seconds=S] [--pre-roll=1] [--verify] in1.wav in2.flac ...
+//
+// Output is latency compensated and as long as the input. Without
+// --chunk-seconds every file is one job. With it, a file is cut into
+// chunks of S seconds that render in parallel, each on its own processor
+// that first runs over the preceding audio so the filter and oversampler
+// state has converged by the time the chunk starts. That pre-roll is
+// --pre-roll seconds, or the processor's tail plus however long the
+// envelope follower takes to forget its level if that is longer.
+// The playhead reports each block's position in the file, which the LFOs
+// start from, so they keep their phase across the seams.
+//
+// --verify also renders every file as a single job, in memory, and exits
+// with status 2 if the chunked output differs from it in any sample.
+
+namespace
+{
+  struct RenderSettings
+  {
+    juce::MemoryBlock state;
+    juce::StringPairArray parameters;
+    juce::File outputDirectory;
+    juce::String format;
+    int blockSize = 512;
+    double chunkSeconds = 0.0;
+    double preRollSeconds = 1.0;
+    bool verify = false;
+  };
+
+  // Release time constants before two envelope followers that started apart
+  // agree to float precision: ln(2^24).
+  constexpr double ReleaseTimeConstants = 17.0;
+
+  // Rendered audio is handed over in segments of at most this many samples,
+  // so a long file never has to sit in memory in one piece.
+  constexpr juce::int64 SegmentSamples = 1 << 18;
+
+  std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& file)
+  {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    return std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
+  }
+
+  bool setParameterText(SkuxAudioProcessor& processor, const juce::String& id, const juce::String& text)
+  {
+    auto* parameter = processor.apvts.getParameter(id);
+
+    if (parameter == nullptr)
+      return false;
+
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(parameter)) {
+      auto index = choice->choices.indexOf(text, true);
+
+      if (index < 0 && text.containsOnly("0123456789"))
+        index = text.getIntValue();
+
+      if (! juce::isPositiveAndBelow(index, choice->choices.size()))
+        return false;
+
+      parameter->setValueNotifyingHost(parameter->convertTo0to1(static_cast<float>(index)));
+      return true;
+    }
+
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(text.getFloatValue()));
+    return true;
+  }
+
+  void configureProcessor(SkuxAudioProcessor& processor, const RenderSettings& settings,
+                          double sampleRate, int numChannels)
+  {
+    if (settings.state.getSize() > 0)
+      processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+
+    for (const auto& id : settings.parameters.getAllKeys())
+      setParameterText(processor, id, settings.parameters[id]);
+
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+    processor.prepareToPlay(sampleRate, settings.blockSize);
+  }
+
+  // Tells the processor where in the file the block it is about to process
+  // starts.
+  class RenderPlayHead : public juce::AudioPlayHead
+  {
+  public:
+    juce::int64 position = 0;
+
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+      PositionInfo info;
+      info.setTimeInSamples(position);
+      info.setIsPlaying(true);
+      return info;
+    }
+  };
+
+  // Everything the jobs rendering one file share. Segments may finish out of
+  // order; they are written as soon as the next one in line is available.
+  class FileRender
+  {
+  public:
+    juce::File input;
+    juce::File output;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    juce::int64 length = 0;
+    int latency = 0;
+    juce::int64 preRoll = 0;
+    // Without a writer the rendered audio is only kept, for --verify.
+    bool keepAudio = false;
+
+    bool openWriter(int bitsPerSample)
+    {
+      juce::AudioFormatManager formatManager;
+      formatManager.registerBasicFormats();
+
+      auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+      if (format == nullptr)
+        return fail("no writer for " + output.getFileExtension());
+
+      const auto bits = format->getPossibleBitDepths().contains(bitsPerSample)
+                          ? bitsPerSample
+                          : format->getPossibleBitDepths().getLast();
+
+      output.deleteFile();
+      auto stream = std::make_unique<juce::FileOutputStream>(output);
+
+      if (! stream->openedOk())
+        return fail("cannot open " + output.getFullPathName());
+
+      m_writer.reset(format->createWriterFor(stream.get(), sampleRate,
+                                             static_cast<unsigned int>(numChannels),
+                                             bits, {}, 0));
+
+      if (m_writer == nullptr)
+        return fail("cannot write " + juce::String(bits) + "-bit " + format->getFormatName());
+
+      stream.release();
+      return true;
+    }
+
+    const juce::AudioBuffer<float>& getAudio() const { return m_audio; }
+
+    void segmentFinished(juce::int64 start, juce::AudioBuffer<float>&& audio)
+    {
+      const juce::ScopedLock lock(m_lock);
+      m_pending.emplace(start, std::move(audio));
+
+      if (keepAudio && m_audio.getNumSamples() == 0)
+        m_audio.setSize(numChannels, static_cast<int>(length));
+
+      for (auto next = m_pending.find(m_written); next != m_pending.end(); next = m_pending.find(m_written)) {
+        const auto& segment = next->second;
+
+        if (m_writer != nullptr && ! m_writer->writeFromAudioSampleBuffer(segment, 0, segment.getNumSamples()))
+          fail("write error");
+
+        if (keepAudio)
+          for (int ch = 0; ch < numChannels; ++ch)
+            m_audio.copyFrom(ch, static_cast<int>(m_written), segment, ch, 0, segment.getNumSamples());
+
+        m_written += segment.getNumSamples();
+        m_pending.erase(next);
+      }
+    }
+
+    bool fail(const juce::String& message)
+    {
+      const juce::ScopedLock lock(m_lock);
+
+      if (m_error.isEmpty())
+        m_error = message;
+
+      return false;
+    }
+
+    juce::String finish()
+    {
+      m_writer.reset();
+
+      if (m_error.isEmpty() && m_written != length)
+        m_error = "rendered " + juce::String(m_written) + " of " + juce::String(length) + " samples";
+
+      return m_error;
+    }
+
+  private:
+    juce::CriticalSection m_lock;
+    std::unique_ptr<juce::AudioFormatWriter> m_writer;
+    std::map<juce::int64, juce::AudioBuffer<float>> m_pending;
+    juce::AudioBuffer<float> m_audio;
+    juce::int64 m_written = 0;
+    juce::String m_error;
+  };
+
+  // Renders output samples [start, end) of one file on a private processor.
+  class RenderJob : public juce::ThreadPoolJob
+  {
+  public:
+    RenderJob(FileRender& file, const RenderSettings& settings, juce::int64 start, juce::int64 end)
+        : juce::ThreadPoolJob(file.input.getFileName()), m_file(file), m_settings(settings),
+          m_start(start), m_end(end)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+      auto reader = createReader(m_file.input);
+
+      if (reader == nullptr) {
+        m_file.fail("cannot read " + m_file.input.getFullPathName());
+        return jobHasFinished;
+      }
+
+      RenderPlayHead playHead;
+      SkuxAudioProcessor processor;
+      configureProcessor(processor, m_settings, m_file.sampleRate, m_file.numChannels);
+      processor.setPlayHead(&playHead);
+
+      // Output sample n is the processor's output for input sample n plus the
+      // reported latency; input past the end of the file reads as silence.
+      const auto streamStart = m_start + m_file.latency;
+      const auto streamEnd = m_end + m_file.latency;
+      auto position = m_start == 0 ? juce::int64(0) : juce::jmax(juce::int64(0), streamStart - m_file.preRoll);
+
+      juce::AudioBuffer<float> block(m_file.numChannels, m_settings.blockSize);
+      juce::AudioBuffer<float> segment;
+      juce::int64 segmentStart = m_start;
+      juce::MidiBuffer midi;
+
+      while (position < streamEnd) {
+        if (shouldExit())
+          return jobHasFinished;
+
+        const auto numSamples = static_cast<int>(juce::jmin(juce::int64(m_settings.blockSize),
+                                                            streamEnd - position));
+        block.setSize(m_file.numChannels, numSamples, false, false, true);
+        reader->read(&block, 0, numSamples, position, true, true);
+        playHead.position = position;
+        processor.processBlock(block, midi);
+
+        for (int offset = static_cast<int>(juce::jmax(juce::int64(0), streamStart - position)); offset < numSamples;) {
+          if (segment.getNumSamples() == 0)
+            segment.setSize(m_file.numChannels,
+                            static_cast<int>(juce::jmin(SegmentSamples, m_end - segmentStart)));
+
+          const auto written = position + offset - m_file.latency - segmentStart;
+          const auto count = juce::jmin(numSamples - offset,
+                                        segment.getNumSamples() - static_cast<int>(written));
+
+          for (int ch = 0; ch < m_file.numChannels; ++ch)
+            segment.copyFrom(ch, static_cast<int>(written), block, ch, offset, count);
+
+          offset += count;
+
+          if (written + count == segment.getNumSamples()) {
+            const auto segmentLength = segment.getNumSamples();
+            m_file.segmentFinished(segmentStart, std::move(segment));
+            segment = juce::AudioBuffer<float>();
+            segmentStart += segmentLength;
+          }
+        }
+
+        position += numSamples;
+      }
+
+      processor.releaseResources();
+      return jobHasFinished;
+    }
+
+  private:
+    FileRender& m_file;
+    const RenderSettings& m_settings;
+    juce::int64 m_start, m_end;
+  };
+
+  juce::StringPairArray parseParameters(const juce::String& text)
+  {
+    juce::StringPairArray parameters;
+
+    for (const auto& token : juce::StringArray::fromTokens(text, ",", "\""))
+      if (token.contains("="))
+        parameters.set(token.upToFirstOccurrenceOf("=", false, false).trim(),
+                       token.fromFirstOccurrenceOf("=", false, false).trim().unquoted());
+
+    return parameters;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  RenderSettings settings;
+  settings.outputDirectory = args.containsOption("--output-dir")
+                               ? args.getFileForOption("--output-dir")
+                               : juce::File::getCurrentWorkingDirectory();
+
+  if (! settings.outputDirectory.createDirectory()) {
+    std::cerr << "Could not create " << settings.outputDirectory.getFullPathName() << std::endl;
+    return 1;
+  }
+
+  settings.format = args.getValueForOption("--format").trimCharactersAtStart(".");
+  settings.parameters = parseParameters(args.getValueForOption("--params"));
+
+  if (args.containsOption("--block-size"))
+    settings.blockSize = juce::jlimit(16, 8192, args.getValueForOption("--block-size").getIntValue());
+
+  if (args.containsOption("--chunk-seconds"))
+    settings.chunkSeconds = args.getValueForOption("--chunk-seconds").getDoubleValue();
+
+  if (args.containsOption("--pre-roll"))
+    settings.preRollSeconds = juce::jmax(0.0, args.getValueForOption("--pre-roll").getDoubleValue());
+
+  settings.verify = args.containsOption("--verify");
+
+  if (args.containsOption("--state")) {
+    const auto stateFile = args.getFileForOption("--state");
+
+    if (! stateFile.loadFileAsData(settings.state)) {
+      std::cerr << "Could not read " << stateFile.getFullPathName() << std::endl;
+      return 1;
+    }
+  }
+
+  {
+    SkuxAudioProcessor reference;
+
+    for (const auto& id : settings.parameters.getAllKeys()) {
+      if (! setParameterText(reference, id, settings.parameters[id])) {
+        std::cerr << "Unknown parameter or value: " << id << "=" << settings.parameters[id] << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  const auto numThreads = args.containsOption("--threads")
+                            ? juce::jmax(1, args.getValueForOption("--threads").getIntValue())
+                            : juce::SystemStats::getNumCpus();
+
+  std::vector<std::unique_ptr<FileRender>> files;
+  // With --verify, the single-job render of each file, in the same order.
+  std::vector<std::unique_ptr<FileRender>> references;
+
+  for (const auto& argument : args.arguments) {
+    if (argument.isOption())
+      continue;
+
+    auto file = std::make_unique<FileRender>();
+    file->input = argument.resolveAsFile();
+
+    const auto reader = createReader(file->input);
+
+    if (reader == nullptr) {
+      std::cerr << "Could not read " << argument.text << std::endl;
+      return 1;
+    }
+
+    file->sampleRate = reader->sampleRate;
+    file->numChannels = static_cast<int>(reader->numChannels);
+    file->length = reader->lengthInSamples;
+
+    if (file->numChannels < 1 || file->numChannels > 2) {
+      std::cerr << argument.text << ": only mono and stereo files are supported" << std::endl;
+      return 1;
+    }
+
+    {
+      SkuxAudioProcessor processor;
+      configureProcessor(processor, settings, file->sampleRate, file->numChannels);
+      file->latency = processor.getLatencySamples();
+
+      const auto releaseSeconds = processor.apvts.getRawParameterValue("Envelope Release")->load() / 1000.0;
+      const auto settleSeconds = processor.getTailLengthSeconds() + ReleaseTimeConstants * releaseSeconds;
+      file->preRoll = static_cast<juce::int64>(juce::jmax(settings.preRollSeconds, settleSeconds) * file->sampleRate);
+    }
+
+    const auto extension = settings.format.isNotEmpty() ? settings.format
+                                                        : file->input.getFileExtension().substring(1);
+    file->output = settings.outputDirectory.getChildFile(file->input.getFileNameWithoutExtension())
+                                           .withFileExtension(extension);
+
+    if (file->output == file->input) {
+      std::cerr << argument.text << ": output would overwrite the input" << std::endl;
+      return 1;
+    }
+
+    if (! file->openWriter(static_cast<int>(reader->bitsPerSample))) {
+      std::cerr << argument.text << ": " << file->finish() << std::endl;
+      return 1;
+    }
+
+    if (settings.verify) {
+      auto reference = std::make_unique<FileRender>();
+      reference->input = file->input;
+      reference->sampleRate = file->sampleRate;
+      reference->numChannels = file->numChannels;
+      reference->length = file->length;
+      reference->latency = file->latency;
+      reference->keepAudio = true;
+      file->keepAudio = true;
+      references.push_back(std::move(reference));
+    }
+
+    files.push_back(std::move(file));
+  }
+
+  if (files.empty()) {
+    std::cerr << "No input files" << std::endl;
+    return 1;
+  }
+
+  juce::ThreadPool pool(juce::ThreadPoolOptions{}.withThreadName("skux-render")
+                                                 .withNumberOfThreads(numThreads));
+
+  for (auto& file : files) {
+    const auto chunkLength = settings.chunkSeconds > 0.0
+                               ? juce::jmax(juce::int64(1), static_cast<juce::int64>(settings.chunkSeconds * file->sampleRate))
+                               : file->length;
+
+    for (juce::int64 start = 0; start < file->length; start += chunkLength)
+      pool.addJob(new RenderJob(*file, settings, start, juce::jmin(file->length, start + chunkLength)), true);
+  }
+
+  for (auto& reference : references)
+    pool.addJob(new RenderJob(*reference, settings, 0, reference->length), true);
+
+  while (pool.getNumJobs() > 0)
+    juce::Thread::sleep(20);
+
+  auto result = 0;
+
+  for (auto& file : files) {
+    const auto error = file->finish();
+
+    if (error.isNotEmpty()) {
+      std::cerr << file->input.getFileName() << ": " << error << std::endl;
+      result = 1;
+    } else {
+      std::cout << file->output.getFullPathName() << std::endl;
+    }
+  }
+
+  for (size_t i = 0; i < references.size(); ++i) {
+    const auto& file = *files[i];
+    const auto error = references[i]->finish();
+
+    if (error.isNotEmpty()) {
+      std::cerr << file.input.getFileName() << ": single-job render: " << error << std::endl;
+      result = 1;
+      continue;
+    }
+
+    const auto& chunked = file.getAudio();
+    const auto& whole = references[i]->getAudio();
+    auto maxError = 0.f;
+
+    for (int ch = 0; ch < file.numChannels; ++ch)
+      for (int s = 0; s < chunked.getNumSamples(); ++s)
+        maxError = juce::jmax(maxError, std::abs(chunked.getSample(ch, s) - whole.getSample(ch, s)));
+
+    if (maxError > 0.f) {
+      std::cerr << "FAILED " << file.input.getFileName() << ": chunked render is up to " << maxError
+                << " off the single-job render" << std::endl;
+
+      if (result == 0)
+        result = 2;
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,337 @@
+#include "Cabinet.h"
+
+namespace
+{
+  constexpr int ResamplerHalfWidth = 32;
+
+  // Hann-windowed sinc, band-limited to the lower of the two Nyquist rates
+  // so downsampling a response does not fold its top octave back down.
+  // Centred on each output sample, so it adds no delay.
+  std::vector<float> resample(const float* input, int length, double ratio)
+  {
+    const auto pi = juce::MathConstants<double>::pi;
+    const auto cutoff = juce::jmin(1.0, 1.0 / ratio);
+    const auto radius = ResamplerHalfWidth / cutoff;
+    std::vector<float> output(static_cast<size_t>(std::ceil(length / ratio)));
+
+    for (size_t n = 0; n < output.size(); ++n) {
+      const auto centre = static_cast<double>(n) * ratio;
+      const auto first = juce::jmax(0, static_cast<int>(std::ceil(centre - radius)));
+      const auto last = juce::jmin(length - 1, static_cast<int>(std::floor(centre + radius)));
+      double sum = 0.0;
+
+      for (int i = first; i <= last; ++i) {
+        const auto t = i - centre;
+        const auto x = pi * t * cutoff;
+        const auto sinc = x == 0.0 ? 1.0 : std::sin(x) / x;
+        sum += input[i] * sinc * (0.5 + 0.5 * std::cos(pi * t / radius));
+      }
+
+      output[n] = static_cast<float>(sum * cutoff);
+    }
+
+    return output;
+  }
+}
+
+Cabinet::Cabinet() : juce::Thread("Skux Cabinet Loader")
+{
+  startThread(juce::Thread::Priority::low);
+}
+
+Cabinet::~Cabinet()
+{
+  stopThread(-1);
+  delete m_pending.exchange(nullptr);
+  delete m_retired.exchange(nullptr);
+}
+
+void Cabinet::prepare(double sampleRate, int maximumBlockSize, int numChannels)
+{
+  // With the loader stopped nothing else touches the source or the slots.
+  // Whatever it was still working on is done here instead.
+  stopThread(-1);
+  delete m_pending.exchange(nullptr);
+  delete m_retired.exchange(nullptr);
+
+  juce::File file;
+  juce::uint32 version = 0;
+
+  {
+    const juce::ScopedLock lock(m_requestLock);
+    file = m_requestedFile;
+    version = m_requestedVersion;
+  }
+
+  if (version != m_builtVersion) {
+    decode(file);
+    m_builtVersion = version;
+  }
+
+  m_sampleRate = sampleRate;
+  m_numChannels = juce::jmax(1, numChannels);
+  m_scratch.setSize(m_numChannels, maximumBlockSize);
+  m_channelPointers.resize(static_cast<size_t>(m_numChannels));
+
+  m_outgoing.reset();
+  m_active = build(m_builtVersion);
+  m_activeVersion.store(m_builtVersion, std::memory_order_relaxed);
+  m_readyVersion.store(m_builtVersion, std::memory_order_release);
+
+  startThread(juce::Thread::Priority::low);
+}
+
+void Cabinet::load(const juce::File& file)
+{
+  {
+    const juce::ScopedLock lock(m_requestLock);
+    m_requestedFile = file;
+    ++m_requestedVersion;
+  }
+
+  notify();
+}
+
+void Cabinet::clear()
+{
+  load(juce::File());
+}
+
+juce::File Cabinet::getFile() const
+{
+  const juce::ScopedLock lock(m_requestLock);
+  return m_requestedFile;
+}
+
+juce::String Cabinet::getFormatWildcard()
+{
+  juce::AudioFormatManager formats;
+  formats.registerBasicFormats();
+  return formats.getWildcardForAllFormats();
+}
+
+void Cabinet::write(juce::MemoryBlock& dest) const
+{
+  const auto path = getFile().getFullPathName();
+  const auto numBytes = path.getNumBytesAsUTF8();
+  const auto magic = juce::ByteOrder::swapIfBigEndian(Magic);
+  const auto size = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(numBytes));
+
+  dest.append(&magic, sizeof(magic));
+  dest.append(&size, sizeof(size));
+  dest.append(path.toRawUTF8(), numBytes);
+}
+
+void Cabinet::read(const void* data, size_t sizeInBytes)
+{
+  const auto* bytes = static_cast<const char*>(data);
+  const auto headerSize = 2 * sizeof(juce::uint32);
+  juce::String path;
+
+  if (data != nullptr && sizeInBytes >= headerSize && juce::ByteOrder::littleEndianInt(bytes) == Magic) {
+    const auto size = juce::ByteOrder::littleEndianInt(bytes + sizeof(juce::uint32));
+
+    if (size <= sizeInBytes - headerSize)
+      path = juce::String::fromUTF8(bytes + headerSize, static_cast<int>(size));
+  }
+
+  const auto file = juce::File::isAbsolutePath(path) ? juce::File(path) : juce::File();
+
+  // Hosts restore the same state often; only a different file reloads.
+  if (file != getFile())
+    load(file);
+}
+
+size_t Cabinet::getStateSize(const void* data, size_t sizeInBytes)
+{
+  const auto* bytes = static_cast<const char*>(data);
+  const auto headerSize = 2 * sizeof(juce::uint32);
+
+  if (data == nullptr || sizeInBytes < headerSize || juce::ByteOrder::littleEndianInt(bytes) != Magic)
+    return 0;
+
+  const auto size = juce::ByteOrder::littleEndianInt(bytes + sizeof(juce::uint32));
+  return size <= sizeInBytes - headerSize ? headerSize + size : 0;
+}
+
+void Cabinet::run()
+{
+  while (! threadShouldExit()) {
+    delete m_retired.exchange(nullptr, std::memory_order_acquire);
+
+    juce::File file;
+    juce::uint32 version = 0;
+
+    {
+      const juce::ScopedLock lock(m_requestLock);
+      file = m_requestedFile;
+      version = m_requestedVersion;
+    }
+
+    if (version == m_builtVersion) {
+      wait(PollIntervalMs);
+      continue;
+    }
+
+    decode(file);
+    m_builtVersion = version;
+    auto response = build(version);
+
+    // prepare() rebuilds it at the new rate anyway.
+    if (threadShouldExit())
+      break;
+
+    // Whichever side exchanges a response out of the slot owns it, so one
+    // the audio thread never got to is simply replaced.
+    delete m_pending.exchange(response.release(), std::memory_order_acq_rel);
+    m_readyVersion.store(version, std::memory_order_release);
+  }
+}
+
+void Cabinet::decode(const juce::File& file)
+{
+  m_source.setSize(0, 0);
+  m_sourceSampleRate = 0.0;
+
+  if (file == juce::File())
+    return;
+
+  juce::AudioFormatManager formats;
+  formats.registerBasicFormats();
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+
+  if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0 || reader->numChannels == 0)
+    return;
+
+  const auto length = static_cast<int>(juce::jmin(reader->lengthInSamples,
+                                                  static_cast<juce::int64>(MaxImpulseSeconds * reader->sampleRate)));
+  const auto numChannels = static_cast<int>(reader->numChannels);
+  juce::AudioBuffer<float> buffer(numChannels, length);
+
+  if (! reader->read(&buffer, 0, length, 0, true, true))
+    return;
+
+  // Stereo and multi-mic responses are folded down to one.
+  m_source.setSize(1, length);
+  m_source.clear();
+
+  for (int ch = 0; ch < numChannels; ++ch)
+    m_source.addFrom(0, 0, buffer, ch, 0, length, 1.f / static_cast<float>(numChannels));
+
+  m_sourceSampleRate = reader->sampleRate;
+}
+
+std::unique_ptr<Cabinet::Response> Cabinet::build(juce::uint32 version) const
+{
+  auto response = std::make_unique<Response>();
+  response->version = version;
+
+  if (m_source.getNumSamples() == 0)
+    return response;
+
+  const auto* source = m_source.getReadPointer(0);
+  const auto length = m_source.getNumSamples();
+  const auto ratio = m_sourceSampleRate / m_sampleRate;
+
+  auto impulse = juce::approximatelyEqual(ratio, 1.0) ? std::vector<float>(source, source + length)
+                                                      : resample(source, length, ratio);
+
+  // Unit energy, so switching responses or rates keeps the level of a
+  // broadband signal.
+  const auto energy = std::inner_product(impulse.begin(), impulse.end(), impulse.begin(), 0.0);
+
+  if (energy > 0.0) {
+    const auto gain = static_cast<float>(1.0 / std::sqrt(energy));
+    for (auto& tap : impulse)
+      tap *= gain;
+  }
+
+  response->convolver = std::make_unique<PartitionedConvolver>(impulse.data(), static_cast<int>(impulse.size()),
+                                                               m_numChannels);
+  return response;
+}
+
+bool Cabinet::canSwap() const
+{
+  return m_outgoing == nullptr && m_retired.load(std::memory_order_acquire) == nullptr;
+}
+
+void Cabinet::swapPending()
+{
+  if (! canSwap())
+    return;
+
+  auto* next = m_pending.exchange(nullptr, std::memory_order_acq_rel);
+  if (next == nullptr)
+    return;
+
+  m_outgoing = std::move(m_active);
+  m_active.reset(next);
+  m_activeVersion.store(next->version, std::memory_order_relaxed);
+}
+
+void Cabinet::finishSwap()
+{
+  if (m_outgoing != nullptr)
+    m_retired.store(m_outgoing.release(), std::memory_order_release);
+}
+
+void Cabinet::reset()
+{
+  if (m_active != nullptr && m_active->convolver != nullptr)
+    m_active->convolver->reset();
+}
+
+template <typename SampleType>
+void Cabinet::process(juce::dsp::AudioBlock<SampleType>& block)
+{
+  convolve(m_active.get(), block);
+}
+
+template <typename SampleType>
+void Cabinet::processOutgoing(juce::dsp::AudioBlock<SampleType>& block)
+{
+  convolve(m_outgoing.get(), block);
+}
+
+template <typename SampleType>
+void Cabinet::convolve(const Response* response, juce::dsp::AudioBlock<SampleType>& block)
+{
+  if (response == nullptr || response->convolver == nullptr)
+    return;
+
+  const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), m_numChannels);
+  const auto numSamples = static_cast<int>(block.getNumSamples());
+
+  if constexpr (std::is_same_v<SampleType, float>) {
+    for (int ch = 0; ch < numChannels; ++ch)
+      m_channelPointers[static_cast<size_t>(ch)] = block.getChannelPointer(static_cast<size_t>(ch));
+
+    response->convolver->process(m_channelPointers.data(), numChannels, numSamples);
+  } else {
+    jassert(numSamples <= m_scratch.getNumSamples());
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const auto* input = block.getChannelPointer(static_cast<size_t>(ch));
+      auto* scratch = m_scratch.getWritePointer(ch);
+
+      for (int s = 0; s < numSamples; ++s)
+        scratch[s] = static_cast<float>(input[s]);
+    }
+
+    response->convolver->process(m_scratch.getArrayOfWritePointers(), numChannels, numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const auto* scratch = m_scratch.getReadPointer(ch);
+      auto* output = block.getChannelPointer(static_cast<size_t>(ch));
+
+      for (int s = 0; s < numSamples; ++s)
+        output[s] = static_cast<SampleType>(scratch[s]);
+    }
+  }
+}
+
+template void Cabinet::process<float>(juce::dsp::AudioBlock<float>&);
+template void Cabinet::process<double>(juce::dsp::AudioBlock<double>&);
+template void Cabinet::processOutgoing<float>(juce::dsp::AudioBlock<float>&);
+template void Cabinet::processOutgoing<double>(juce::dsp::AudioBlock<double>&);
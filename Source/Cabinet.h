@@ -0,0 +1,106 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+// Optional speaker cabinet: a mono impulse response convolved with every
+// output channel after the distortion, through a zero-latency
+// PartitionedConvolver. Files are decoded, resampled and partitioned on a
+// background thread; the audio thread only ever swaps in a finished
+// response, and the loader frees the one it replaced.
+class Cabinet : private juce::Thread
+{
+public:
+  // Longer files are truncated; a cabinet rings out well within this.
+  static constexpr double MaxImpulseSeconds = 1.0;
+
+  Cabinet();
+  ~Cabinet() override;
+
+  // Not on the audio thread. Decodes the file load() or read() last asked
+  // for, if the loader has not got to it yet, and builds its response for
+  // the new rate before returning, so playback always starts with it.
+  void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+
+  // Message thread; both return at once and the loader does the work. A
+  // file that cannot be decoded leaves the cabinet empty, passing audio
+  // through unchanged.
+  void load(const juce::File& file);
+  void clear();
+  juce::File getFile() const;
+  // For file choosers: every format load() can decode.
+  static juce::String getFormatWildcard();
+
+  // Appended to the plugin state after the MIDI mappings:
+  //   uint32 magic, uint32 byte count, UTF-8 path
+  void write(juce::MemoryBlock& dest) const;
+  // Loads the stored file, or clears the response if data does not start
+  // with one.
+  void read(const void* data, size_t sizeInBytes);
+  // Bytes a stored chunk at data occupies, or 0 if there is none.
+  static size_t getStateSize(const void* data, size_t sizeInBytes);
+
+  // Version of the newest response the loader has finished; it differs from
+  // the active one until swapPending() takes it.
+  juce::uint32 getReadyVersion() const { return m_readyVersion.load(std::memory_order_acquire); }
+  juce::uint32 getActiveVersion() const { return m_activeVersion.load(std::memory_order_relaxed); }
+
+  // Audio thread. The new response starts from an empty history; the one it
+  // replaces keeps running through processOutgoing() until finishSwap(), so
+  // the processor can crossfade between the two. canSwap() is false until
+  // the loader has freed the response before that.
+  bool canSwap() const;
+  void swapPending();
+  void finishSwap();
+  bool isSwapping() const { return m_outgoing != nullptr; }
+  void reset();
+
+  template <typename SampleType>
+  void process(juce::dsp::AudioBlock<SampleType>& block);
+  template <typename SampleType>
+  void processOutgoing(juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+  struct Response
+  {
+    std::unique_ptr<PartitionedConvolver> convolver;
+    juce::uint32 version = 0;
+  };
+
+  static constexpr int PollIntervalMs = 20;
+  static constexpr juce::uint32 Magic = 0x434b5853; // "SXKC"
+
+  void run() override;
+  void decode(const juce::File& file);
+  std::unique_ptr<Response> build(juce::uint32 version) const;
+
+  template <typename SampleType>
+  void convolve(const Response* response, juce::dsp::AudioBlock<SampleType>& block);
+
+  // Message thread writes, loader reads.
+  juce::CriticalSection m_requestLock;
+  juce::File m_requestedFile;
+  juce::uint32 m_requestedVersion = 0;
+
+  // Loader only, or any thread while the loader is stopped.
+  juce::AudioBuffer<float> m_source;
+  double m_sourceSampleRate = 0.0;
+  juce::uint32 m_builtVersion = 0;
+  double m_sampleRate = 44100.0;
+  int m_numChannels = 2;
+
+  // The loader publishes into m_pending, the audio thread moves it to
+  // m_active and, once the crossfade is over, hands the old one back
+  // through m_retired.
+  std::atomic<Response*> m_pending{ nullptr };
+  std::atomic<Response*> m_retired{ nullptr };
+  std::unique_ptr<Response> m_active;
+  std::unique_ptr<Response> m_outgoing;
+  std::atomic<juce::uint32> m_readyVersion{ 0 };
+  std::atomic<juce::uint32> m_activeVersion{ 0 };
+
+  // Float copy of a double block; the convolver only works in float.
+  juce::AudioBuffer<float> m_scratch;
+  std::vector<float*> m_channelPointers;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Cabinet)
+};
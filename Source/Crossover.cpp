@@ -0,0 +1,86 @@
+#include "Crossover.h"
+
+template <typename SampleType>
+void Crossover<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+  // The splits write both outputs at once, so only the allpasses need a type.
+  for (auto& filter : m_splits)
+    filter.prepare(spec);
+
+  for (auto& filter : m_allpasses) {
+    filter.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+    filter.prepare(spec);
+  }
+
+  m_maxFrequency = static_cast<float>(0.45 * spec.sampleRate);
+}
+
+template <typename SampleType>
+void Crossover<SampleType>::reset()
+{
+  for (auto& filter : m_splits)
+    filter.reset();
+
+  for (auto& filter : m_allpasses)
+    filter.reset();
+}
+
+template <typename SampleType>
+void Crossover<SampleType>::setCrossovers(int numBands, const Frequencies& frequencies)
+{
+  numBands = juce::jlimit(1, MaxBands, numBands);
+
+  if (numBands != m_numBands) {
+    m_numBands = numBands;
+    reset();
+  }
+
+  auto sorted = frequencies;
+  std::sort(sorted.begin(), sorted.begin() + (numBands - 1));
+
+  for (auto& frequency : sorted)
+    frequency = juce::jlimit(20.f, m_maxFrequency, frequency);
+
+  for (int i = 0; i < numBands - 1; ++i)
+    m_splits[static_cast<size_t>(i)].setCutoffFrequency(static_cast<SampleType>(sorted[static_cast<size_t>(i)]));
+
+  if (numBands == 3) {
+    m_allpasses[0].setCutoffFrequency(static_cast<SampleType>(sorted[1]));
+  } else if (numBands == 4) {
+    m_allpasses[0].setCutoffFrequency(static_cast<SampleType>(sorted[2]));
+    m_allpasses[1].setCutoffFrequency(static_cast<SampleType>(sorted[0]));
+  }
+}
+
+template <typename SampleType>
+void Crossover<SampleType>::split(int channel, SampleType input, SampleType* bands) noexcept
+{
+  switch (m_numBands) {
+    case 2:
+      m_splits[0].processSample(channel, input, bands[0], bands[1]);
+      break;
+
+    case 3: {
+      SampleType low, rest;
+      m_splits[0].processSample(channel, input, low, rest);
+      m_splits[1].processSample(channel, rest, bands[1], bands[2]);
+      bands[0] = m_allpasses[0].processSample(channel, low);
+      break;
+    }
+
+    case 4: {
+      SampleType low, high;
+      m_splits[1].processSample(channel, input, low, high);
+      m_splits[0].processSample(channel, m_allpasses[0].processSample(channel, low), bands[0], bands[1]);
+      m_splits[2].processSample(channel, m_allpasses[1].processSample(channel, high), bands[2], bands[3]);
+      break;
+    }
+
+    default:
+      bands[0] = input;
+      break;
+  }
+}
+
+template class Crossover<float>;
+template class Crossover<double>;
@@ -0,0 +1,33 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Linkwitz-Riley (24 dB/oct) band splitter for the multiband mode. Bands
+// are split as a tree, with allpasses on the shorter branches so every band
+// carries the same phase; summing the bands gives back the input through
+// one allpass per crossover and no change in level.
+template <typename SampleType>
+class Crossover
+{
+public:
+  static constexpr int MaxBands = 4;
+  using Frequencies = std::array<float, MaxBands - 1>;
+
+  void prepare(const juce::dsp::ProcessSpec& spec);
+  void reset();
+
+  // Only the first numBands - 1 frequencies are used. They are sorted and
+  // kept below Nyquist; changing the band count clears the filter state.
+  void setCrossovers(int numBands, const Frequencies& frequencies);
+  int getNumBands() const { return m_numBands; }
+
+  // Writes getNumBands() samples into bands, lowest band first.
+  void split(int channel, SampleType input, SampleType* bands) noexcept;
+
+private:
+  using LRFilter = juce::dsp::LinkwitzRileyFilter<SampleType>;
+
+  std::array<LRFilter, MaxBands - 1> m_splits;
+  std::array<LRFilter, 2> m_allpasses;
+  int m_numBands = 1;
+  float m_maxFrequency = 20000.f;
+};
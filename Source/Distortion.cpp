@@ -1,30 +1,992 @@
 #include "Distortion.h"
 
-void Distortion::process(juce::AudioBuffer<float>& buffer,
-                         float drive, float mix, int clipType)
+template <typename SampleType>
+void Distortion<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-  if (mix <= 0.f)
+  for (size_t i = 0; i < m_iirOversamplers.size(); ++i) {
+    const auto stages = i + 1;
+
+    m_iirOversamplers[i] = std::make_unique<Oversampler>(
+      spec.numChannels, stages, Oversampler::filterHalfBandPolyphaseIIR, true, true);
+    m_firOversamplers[i] = std::make_unique<Oversampler>(
+      spec.numChannels, stages, Oversampler::filterHalfBandFIREquiripple, true, true);
+
+    m_iirOversamplers[i]->initProcessing(spec.maximumBlockSize);
+    m_firOversamplers[i]->initProcessing(spec.maximumBlockSize);
+  }
+
+  for (size_t i = 0; i < m_crossovers.size(); ++i) {
+    auto oversampledSpec = spec;
+    oversampledSpec.sampleRate *= static_cast<double>(1 << i);
+    oversampledSpec.maximumBlockSize <<= i;
+    m_crossovers[i].prepare(oversampledSpec);
+  }
+
+  const auto maxOversampledSize = static_cast<int>(spec.maximumBlockSize) << (NumOversamplingFactors - 1);
+  m_qualityBlendBuffer.setSize(static_cast<int>(spec.numChannels), maxOversampledSize);
+  m_qualityBlend.resize(static_cast<size_t>(maxOversampledSize));
+  m_qualityBlendLength = juce::roundToInt(spec.sampleRate * Quality::blendSeconds);
+  m_qualityBlendPosition = m_qualityBlendLength;
+  m_isRunning = false;
+
+  m_adaaStates.assign(spec.numChannels, ADAAState{});
+  m_wetGainValid = false;
+  m_sideWetGainValid = false;
+  m_crossoversValid = false;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::reset()
+{
+  for (auto& oversampler : m_iirOversamplers) {
+    if (oversampler != nullptr)
+      oversampler->reset();
+  }
+
+  for (auto& oversampler : m_firOversamplers) {
+    if (oversampler != nullptr)
+      oversampler->reset();
+  }
+
+  for (auto& crossover : m_crossovers)
+    crossover.reset();
+
+  std::fill(m_adaaStates.begin(), m_adaaStates.end(), ADAAState{});
+  m_qualityBlendPosition = m_qualityBlendLength;
+  m_isRunning = false;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setQuality(Quality::Level quality)
+{
+  if (quality == m_quality)
+    return;
+
+  // A stage that has not run since prepare() or reset() has nothing to
+  // click against, so it switches right away.
+  m_previousQuality = m_quality;
+  m_quality = quality;
+  m_qualityBlendPosition = m_isRunning ? 0 : m_qualityBlendLength;
+}
+
+template <typename SampleType>
+const SampleType* Distortion<SampleType>::getQualityBlend(int numSamples)
+{
+  if (m_qualityBlendPosition >= m_qualityBlendLength)
+    return nullptr;
+
+  // Oversampled blocks step through the same blend in smaller steps.
+  const auto position = m_qualityBlendPosition << m_oversamplingIndex;
+  const auto length = static_cast<SampleType>(m_qualityBlendLength << m_oversamplingIndex);
+
+  for (int s = 0; s < numSamples; ++s) {
+    const auto weight = static_cast<SampleType>(position + s + 1) / length;
+    m_qualityBlend[static_cast<size_t>(s)] = juce::jmin(SampleType(1), weight);
+  }
+
+  return m_qualityBlend.data();
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::advanceQualityBlend(int numSamples)
+{
+  m_qualityBlendPosition = juce::jmin(m_qualityBlendLength, m_qualityBlendPosition + numSamples);
+  m_isRunning = true;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setOversampling(int factorIndex, bool linearPhase)
+{
+  factorIndex = juce::jlimit(0, NumOversamplingFactors - 1, factorIndex);
+
+  if (factorIndex == m_oversamplingIndex && linearPhase == m_linearPhase)
     return;
 
-  const auto numChannels = buffer.getNumChannels();
-  const auto numSamples = buffer.getNumSamples();
+  m_oversamplingIndex = factorIndex;
+  m_linearPhase = linearPhase;
+
+  // The newly selected stage still holds whatever it saw when it was last
+  // active, so start it from silence.
+  if (auto* oversampler = getActiveOversampler())
+    oversampler->reset();
+
+  m_crossovers[static_cast<size_t>(m_oversamplingIndex)].reset();
+  m_crossoversValid = false;
+
+  std::fill(m_adaaStates.begin(), m_adaaStates.end(), ADAAState{});
+}
+
+template <typename SampleType>
+int Distortion<SampleType>::getLatencySamples() const
+{
+  if (auto* oversampler = getActiveOversampler())
+    return static_cast<int>(std::round(oversampler->getLatencyInSamples()));
+
+  return 0;
+}
+
+template <typename SampleType>
+typename Distortion<SampleType>::Oversampler* Distortion<SampleType>::getActiveOversampler() const
+{
+  if (m_oversamplingIndex == 0)
+    return nullptr;
+
+  const auto index = static_cast<size_t>(m_oversamplingIndex - 1);
+  return m_linearPhase ? m_firOversamplers[index].get() : m_iirOversamplers[index].get();
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::process(juce::dsp::AudioBlock<SampleType>& block,
+                                     const ParameterRamp& drive, const ParameterRamp& mix,
+                                     int clipType, const StereoParameters& stereo, bool gainChanged)
+{
+  // A mono block has no side to encode, so it always runs as plain stereo.
+  const auto midSide = stereo.isMidSide() && block.getNumChannels() >= 2;
+  const auto midMix = midSide ? stereo.getMidMix(mix) : mix;
+  const auto sideMix = stereo.getSideMix();
+
+  if (drive.isConstant() && midMix.isConstant() && (gainChanged || ! m_wetGainValid)) {
+    m_wetGain = getWetGain(clipType, drive.value, midMix.value);
+    m_wetGainValid = true;
+  }
+
+  if (midSide && stereo.sideDrive.isConstant() && sideMix.isConstant()
+      && (gainChanged || ! m_sideWetGainValid)) {
+    m_sideWetGain = getWetGain(clipType, stereo.sideDrive.value, sideMix.value);
+    m_sideWetGainValid = true;
+  }
+
+  const auto isMutedMix = [](const ParameterRamp& ramp) {
+    return ramp.isConstant() && ramp.value <= 0.f;
+  };
+
+  const auto isMuted = isMutedMix(midMix) && (! midSide || isMutedMix(sideMix));
+
+  if (clipType != m_adaaClipType) {
+    rebaseADAAStates(clipType);
+    m_adaaClipType = clipType;
+  }
+
+  processOversampled(block, isMuted, [&](auto& oversampledBlock, int factorLog2) {
+    if (midSide) {
+      processMidSideBlock(oversampledBlock,
+                          drive.withOversampling(factorLog2),
+                          midMix.withOversampling(factorLog2),
+                          stereo.sideDrive.withOversampling(factorLog2),
+                          sideMix.withOversampling(factorLog2),
+                          clipType);
+    } else {
+      processBlock(oversampledBlock,
+                   drive.withOversampling(factorLog2),
+                   mix.withOversampling(factorLog2),
+                   clipType);
+    }
+  });
+
+  advanceQualityBlend(static_cast<int>(block.getNumSamples()));
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::processScalar(juce::dsp::AudioBlock<SampleType>& block, float drive,
+                                           float mix, int clipType)
+{
+  // processRamped never loads a register, and constant ramps make it work
+  // out the same wet gain process() caches.
+  const ParameterRamp driveRamp{ drive };
+  const ParameterRamp mixRamp{ mix };
+
+  switch (clipType) {
+    case softClip:
+      withSoftClip(m_quality, [&](auto soft) { processRamped<decltype(soft)>(block, driveRamp, mixRamp); });
+      break;
+    case hardClip: processRamped<HardClip>(block, driveRamp, mixRamp); break;
+    default:       jassertfalse; break;
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::processMultiband(juce::dsp::AudioBlock<SampleType>& block,
+                                              const MultibandParameters& bands,
+                                              const StereoParameters& stereo,
+                                              bool crossoversChanged)
+{
+  if (crossoversChanged || ! m_crossoversValid) {
+    m_crossovers[static_cast<size_t>(m_oversamplingIndex)].setCrossovers(bands.numBands,
+                                                                         bands.crossovers);
+    m_crossoversValid = true;
+  }
+
+  // Even with every band muted the crossover's allpass stays on the signal,
+  // so there is no shortcut here.
+  processOversampled(block, false, [&](auto& oversampledBlock, int factorLog2) {
+    if (! stereo.isMidSide() || oversampledBlock.getNumChannels() < 2) {
+      processBands(oversampledBlock, bands, factorLog2);
+      return;
+    }
+
+    // The per-sample crossover split has no room for the encode, so mid/side
+    // wraps the band pass instead; Mid Only and Side Only skip the other one.
+    auto* left = oversampledBlock.getChannelPointer(0);
+    auto* right = oversampledBlock.getChannelPointer(1);
+    const auto numSamples = static_cast<int>(oversampledBlock.getNumSamples());
+    const auto firstChannel = stereo.mode == StereoParameters::sideOnly ? 1 : 0;
+    const auto numChannels = stereo.mode == StereoParameters::midSide ? 2 : 1;
+
+    encodeMidSide(left, right, numSamples);
+
+    auto channels = oversampledBlock.getSubsetChannelBlock(static_cast<size_t>(firstChannel),
+                                                           static_cast<size_t>(numChannels));
+    processBands(channels, bands, factorLog2);
+
+    decodeMidSide(left, right, numSamples);
+  });
+
+  advanceQualityBlend(static_cast<int>(block.getNumSamples()));
+}
+
+template <typename SampleType>
+template <typename Function>
+void Distortion<SampleType>::processOversampled(juce::dsp::AudioBlock<SampleType>& block,
+                                                bool isMuted, Function&& function)
+{
+  auto* oversampler = getActiveOversampler();
+
+  if (oversampler == nullptr) {
+    if (! isMuted)
+      function(block, 0);
+    return;
+  }
+
+  // The resampling filters run even when the wet signal is muted so the
+  // output keeps the latency reported to the host.
+  auto oversampledBlock = oversampler->processSamplesUp(block);
+
+  if (! isMuted)
+    function(oversampledBlock, m_oversamplingIndex);
+
+  oversampler->processSamplesDown(block);
+}
+
+template <typename SampleType>
+template <typename Function>
+void Distortion<SampleType>::processSoftClip(juce::dsp::AudioBlock<SampleType>& block, Function&& function)
+{
+  const auto* blend = getQualityBlend(static_cast<int>(block.getNumSamples()));
+
+  if (blend == nullptr) {
+    withSoftClip(m_quality, [&](auto soft) { function(block, soft); });
+    return;
+  }
+
+  // The plain soft clip keeps no state, so the old curve can run on a copy
+  // and the two meet in a per-sample crossfade.
+  auto previous = juce::dsp::AudioBlock<SampleType>(m_qualityBlendBuffer)
+                    .getSubsetChannelBlock(0, block.getNumChannels())
+                    .getSubBlock(0, block.getNumSamples());
+  previous.copyFrom(block);
+
+  withSoftClip(m_previousQuality, [&](auto soft) { function(previous, soft); });
+  withSoftClip(m_quality, [&](auto soft) { function(block, soft); });
+
+  for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+    auto* data = block.getChannelPointer(ch);
+    const auto* old = previous.getChannelPointer(ch);
+
+    for (size_t s = 0; s < block.getNumSamples(); ++s)
+      data[s] = old[s] + (data[s] - old[s]) * blend[s];
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::processBlock(juce::dsp::AudioBlock<SampleType>& block,
+                                          const ParameterRamp& drive, const ParameterRamp& mix,
+                                          int clipType)
+{
+  switch (clipType) {
+    case softClip:
+      processSoftClip(block, [&](auto& target, auto soft) {
+        processShaper<decltype(soft)>(target, drive, mix, m_wetGain);
+      });
+      break;
+    case hardClip:      processShaper<HardClip>(block, drive, mix, m_wetGain); break;
+    case softClipADAA1: processADAA<SoftClip, 1>(block, drive, mix, m_wetGain); break;
+    case softClipADAA2: processADAA<SoftClip, 2>(block, drive, mix, m_wetGain); break;
+    case hardClipADAA1: processADAA<HardClip, 1>(block, drive, mix, m_wetGain); break;
+    case hardClipADAA2: processADAA<HardClip, 2>(block, drive, mix, m_wetGain); break;
+    default:            jassertfalse; break;
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processShaper(juce::dsp::AudioBlock<SampleType>& block,
+                                           const ParameterRamp& drive, const ParameterRamp& mix,
+                                           float wetGain)
+{
+  if (drive.isConstant() && mix.isConstant())
+    processChannels<Shaper>(block, drive.value, mix.value, wetGain);
+  else
+    processRamped<Shaper>(block, drive, mix);
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processChannels(juce::dsp::AudioBlock<SampleType>& block,
+                                             float drive, float mix, float wetGain)
+{
+  const auto numChannels = static_cast<int>(block.getNumChannels());
+  const auto numSamples = static_cast<int>(block.getNumSamples());
   const auto dryGain = 1.f - mix;
-  const auto wetGain = (clipType == 0)
-    ? mix / std::pow(drive, 0.45f)
-    : mix / std::pow(drive, 0.6f);
+
+  int ch = 0;
+
+  for (; ch + 1 < numChannels; ch += 2) {
+    processStereo<Shaper>(block.getChannelPointer(static_cast<size_t>(ch)),
+                          block.getChannelPointer(static_cast<size_t>(ch + 1)),
+                          numSamples, drive, dryGain, wetGain);
+  }
+
+  if (ch < numChannels) {
+    processMono<Shaper>(block.getChannelPointer(static_cast<size_t>(ch)),
+                        numSamples, drive, dryGain, wetGain);
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processRamped(juce::dsp::AudioBlock<SampleType>& block,
+                                           const ParameterRamp& drive, const ParameterRamp& mix)
+{
+  constexpr int chunkSize = 64;
+
+  const auto numChannels = block.getNumChannels();
+  const auto numSamples = static_cast<int>(block.getNumSamples());
+
+  SampleType drives[chunkSize];
+  SampleType dryGains[chunkSize];
+  SampleType wetGains[chunkSize];
+
+  // The gains are shared by every channel, so they are worked out once per
+  // chunk rather than once per sample and channel.
+  for (int start = 0; start < numSamples; start += chunkSize) {
+    const auto n = juce::jmin(chunkSize, numSamples - start);
+
+    for (int i = 0; i < n; ++i) {
+      drives[i] = drive[start + i];
+      dryGains[i] = 1.f - mix[start + i];
+      wetGains[i] = getWetGain<Shaper>(drives[i], mix[start + i]);
+    }
+
+    for (size_t ch = 0; ch < numChannels; ++ch) {
+      auto* data = block.getChannelPointer(ch) + start;
+
+      for (int i = 0; i < n; ++i)
+        data[i] = data[i] * dryGains[i] + Shaper::apply(data[i] * drives[i]) * wetGains[i];
+    }
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processStereo(SampleType* left, SampleType* right, int numSamples,
+                                           SampleType drive, SampleType dryGain, SampleType wetGain)
+{
+  const auto head = getAlignmentOffset(left, numSamples);
+
+  // Both channels have to share an alignment to be walked by the same loop.
+  if (head != getAlignmentOffset(right, numSamples)) {
+    processMono<Shaper>(left, numSamples, drive, dryGain, wetGain);
+    processMono<Shaper>(right, numSamples, drive, dryGain, wetGain);
+    return;
+  }
+
+  int s = 0;
+
+  for (; s < head; ++s) {
+    left[s] = left[s] * dryGain + Shaper::apply(left[s] * drive) * wetGain;
+    right[s] = right[s] * dryGain + Shaper::apply(right[s] * drive) * wetGain;
+  }
+
+  constexpr auto step = static_cast<int>(SIMDType::SIMDNumElements);
+
+  for (; s + step <= numSamples; s += step) {
+    const auto dryL = SIMDType::fromRawArray(left + s);
+    const auto dryR = SIMDType::fromRawArray(right + s);
+
+    (dryL * dryGain + Shaper::apply(dryL * drive) * wetGain).copyToRawArray(left + s);
+    (dryR * dryGain + Shaper::apply(dryR * drive) * wetGain).copyToRawArray(right + s);
+  }
+
+  for (; s < numSamples; ++s) {
+    left[s] = left[s] * dryGain + Shaper::apply(left[s] * drive) * wetGain;
+    right[s] = right[s] * dryGain + Shaper::apply(right[s] * drive) * wetGain;
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processMono(SampleType* data, int numSamples,
+                                         SampleType drive, SampleType dryGain, SampleType wetGain)
+{
+  const auto head = getAlignmentOffset(data, numSamples);
+  int s = 0;
+
+  for (; s < head; ++s)
+    data[s] = data[s] * dryGain + Shaper::apply(data[s] * drive) * wetGain;
+
+  constexpr auto step = static_cast<int>(SIMDType::SIMDNumElements);
+
+  for (; s + step <= numSamples; s += step) {
+    const auto dry = SIMDType::fromRawArray(data + s);
+    (dry * dryGain + Shaper::apply(dry * drive) * wetGain).copyToRawArray(data + s);
+  }
+
+  for (; s < numSamples; ++s)
+    data[s] = data[s] * dryGain + Shaper::apply(data[s] * drive) * wetGain;
+}
+
+template <typename SampleType>
+template <typename Shaper, int Order>
+void Distortion<SampleType>::processADAA(juce::dsp::AudioBlock<SampleType>& block,
+                                         const ParameterRamp& drive, const ParameterRamp& mix,
+                                         float wetGain)
+{
+  const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()),
+                                      static_cast<int>(m_adaaStates.size()));
+  const auto numSamples = static_cast<int>(block.getNumSamples());
 
   for (int ch = 0; ch < numChannels; ++ch) {
-    auto* data = buffer.getWritePointer(ch);
+    auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+    auto& state = m_adaaStates[static_cast<size_t>(ch)];
 
-    for (int s = 0; s < numSamples; ++s) {
-      const auto dry = data[s];
-      const auto driven = dry * drive;
+    if constexpr (Order == 1)
+      processADAA1<Shaper>(data, numSamples, state, drive, mix, wetGain);
+    else
+      processADAA2<Shaper>(data, numSamples, state, drive, mix, wetGain);
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::rebaseADAAStates(int clipType)
+{
+  // The plain curves don't keep the history up to date, so coming from one
+  // of them the ADAA kernels start again from silence.
+  const auto keepHistory = m_adaaClipType != softClip && m_adaaClipType != hardClip;
+
+  switch (clipType) {
+    case softClipADAA1: rebaseADAAStates<SoftClip, 1>(keepHistory); break;
+    case softClipADAA2: rebaseADAAStates<SoftClip, 2>(keepHistory); break;
+    case hardClipADAA1: rebaseADAAStates<HardClip, 1>(keepHistory); break;
+    case hardClipADAA2: rebaseADAAStates<HardClip, 2>(keepHistory); break;
+    default:            break;
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper, int Order>
+void Distortion<SampleType>::rebaseADAAStates(bool keepHistory)
+{
+  for (auto& state : m_adaaStates) {
+    if (! keepHistory) {
+      state = ADAAState{};
+      continue;
+    }
+
+    if constexpr (Order == 1) {
+      state.antiderivative = Shaper::antiderivative1(state.x1);
+    } else {
+      const auto diff = state.x1 - state.x2;
+
+      state.antiderivative = Shaper::antiderivative2(state.x1);
+      state.difference = std::abs(diff) < ADAATolerance
+                           ? Shaper::antiderivative1((state.x1 + state.x2) * 0.5)
+                           : (state.antiderivative - Shaper::antiderivative2(state.x2)) / diff;
+    }
+  }
+}
+
+// Fills dst with src delayed by one sample, seeded with the previous chunk's
+// last value, so every kernel below can use aligned loads for both taps.
+static void shiftByOne(double* dst, const double* src, int numSamples, double previous)
+{
+  dst[0] = previous;
+  std::copy(src, src + numSamples - 1, dst + 1);
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::mixADAAChunk(SampleType* data, const double* dry, const double* wet,
+                                          int offset, int numSamples, const ParameterRamp& drive,
+                                          const ParameterRamp& mix, float wetGain)
+{
+  if (drive.isConstant() && mix.isConstant()) {
+    const auto dryGain = 1.0 - mix.value;
+    const double constantWetGain = wetGain;
+
+    for (int i = 0; i < numSamples; ++i)
+      data[i] = static_cast<SampleType>(dry[i] * dryGain + wet[i] * constantWetGain);
+
+    return;
+  }
+
+  for (int i = 0; i < numSamples; ++i) {
+    const auto m = mix[offset + i];
+    const double wetGain = getWetGain<Shaper>(drive[offset + i], m);
+
+    data[i] = static_cast<SampleType>(dry[i] * (1.0 - m) + wet[i] * wetGain);
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processADAA1(SampleType* data, int numSamples, ADAAState& state,
+                                          const ParameterRamp& drive, const ParameterRamp& mix,
+                                          float wetGain)
+{
+  constexpr auto alignment = juce::dsp::SIMDRegister<double>::SIMDRegisterSize;
+
+  alignas(alignment) double dry[ADAAChunkSize];
+  alignas(alignment) double x0[ADAAChunkSize];
+  alignas(alignment) double x1[ADAAChunkSize];
+  alignas(alignment) double ad0[ADAAChunkSize];
+  alignas(alignment) double ad1[ADAAChunkSize];
+  alignas(alignment) double wet[ADAAChunkSize];
+
+  for (int start = 0; start < numSamples; start += ADAAChunkSize) {
+    const auto n = juce::jmin(ADAAChunkSize, numSamples - start);
+    auto* chunk = data + start;
+
+    for (int i = 0; i < n; ++i) {
+      dry[i] = chunk[i];
+      x0[i] = dry[i] * drive[start + i];
+    }
+
+    shiftByOne(x1, x0, n, state.x1);
+
+    simdForEach<double>(n, [&](int i, auto lane) {
+      using T = decltype(lane);
+      simdStore(Shaper::antiderivative1(simdLoad<T>(x0 + i)), ad0 + i);
+    });
+
+    shiftByOne(ad1, ad0, n, state.antiderivative);
+
+    simdForEach<double>(n, [&](int i, auto lane) {
+      using T = decltype(lane);
+
+      const auto cur = simdLoad<T>(x0 + i);
+      const auto prev = simdLoad<T>(x1 + i);
+      const auto diff = cur - prev;
+      const auto illConditioned = simdLessThan(simdAbs(diff), simdBroadcast<T>(ADAATolerance));
+
+      auto shaped = simdDivide(simdLoad<T>(ad0 + i) - simdLoad<T>(ad1 + i),
+                               simdSelect(illConditioned, simdBroadcast<T>(1.0), diff));
+
+      if (simdAny(illConditioned))
+        shaped = simdSelect(illConditioned, Shaper::apply((cur + prev) * 0.5), shaped);
+
+      simdStore(shaped, wet + i);
+    });
+
+    mixADAAChunk<Shaper>(chunk, dry, wet, start, n, drive, mix, wetGain);
+
+    // x2 isn't needed here, but keeps the history whole for a switch to
+    // second order.
+    state.x2 = n > 1 ? x0[n - 2] : state.x1;
+    state.x1 = x0[n - 1];
+    state.antiderivative = ad0[n - 1];
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processADAA2(SampleType* data, int numSamples, ADAAState& state,
+                                          const ParameterRamp& drive, const ParameterRamp& mix,
+                                          float wetGain)
+{
+  constexpr auto alignment = juce::dsp::SIMDRegister<double>::SIMDRegisterSize;
+
+  alignas(alignment) double dry[ADAAChunkSize];
+  alignas(alignment) double x0[ADAAChunkSize];
+  alignas(alignment) double x1[ADAAChunkSize];
+  alignas(alignment) double x2[ADAAChunkSize];
+  alignas(alignment) double ad0[ADAAChunkSize];
+  alignas(alignment) double ad1[ADAAChunkSize];
+  alignas(alignment) double d0[ADAAChunkSize];
+  alignas(alignment) double d1[ADAAChunkSize];
+  alignas(alignment) double wet[ADAAChunkSize];
+
+  for (int start = 0; start < numSamples; start += ADAAChunkSize) {
+    const auto n = juce::jmin(ADAAChunkSize, numSamples - start);
+    auto* chunk = data + start;
+
+    for (int i = 0; i < n; ++i) {
+      dry[i] = chunk[i];
+      x0[i] = dry[i] * drive[start + i];
+    }
+
+    shiftByOne(x1, x0, n, state.x1);
+    shiftByOne(x2, x1, n, state.x2);
+
+    simdForEach<double>(n, [&](int i, auto lane) {
+      using T = decltype(lane);
+      simdStore(Shaper::antiderivative2(simdLoad<T>(x0 + i)), ad0 + i);
+    });
+
+    shiftByOne(ad1, ad0, n, state.antiderivative);
+
+    // First divided difference of the second antiderivative.
+    simdForEach<double>(n, [&](int i, auto lane) {
+      using T = decltype(lane);
+
+      const auto cur = simdLoad<T>(x0 + i);
+      const auto prev = simdLoad<T>(x1 + i);
+      const auto diff = cur - prev;
+      const auto illConditioned = simdLessThan(simdAbs(diff), simdBroadcast<T>(ADAATolerance));
+
+      auto difference = simdDivide(simdLoad<T>(ad0 + i) - simdLoad<T>(ad1 + i),
+                                   simdSelect(illConditioned, simdBroadcast<T>(1.0), diff));
+
+      if (simdAny(illConditioned))
+        difference = simdSelect(illConditioned, Shaper::antiderivative1((cur + prev) * 0.5), difference);
+
+      simdStore(difference, d0 + i);
+    });
+
+    shiftByOne(d1, d0, n, state.difference);
+
+    simdForEach<double>(n, [&](int i, auto lane) {
+      using T = decltype(lane);
+
+      const auto one = simdBroadcast<T>(1.0);
+      const auto tolerance = simdBroadcast<T>(ADAATolerance);
+      const auto cur = simdLoad<T>(x0 + i);
+      const auto last = simdLoad<T>(x2 + i);
+      const auto span = cur - last;
+      const auto illConditioned = simdLessThan(simdAbs(span), tolerance);
+
+      auto shaped = simdDivide((simdLoad<T>(d0 + i) - simdLoad<T>(d1 + i)) * 2.0,
+                               simdSelect(illConditioned, one, span));
+
+      if (simdAny(illConditioned)) {
+        const auto mid = simdLoad<T>(x1 + i);
+        const auto xBar = (cur + last) * 0.5;
+        const auto delta = xBar - mid;
+        const auto flat = simdLessThan(simdAbs(delta), tolerance);
+        const auto safeDelta = simdSelect(flat, one, delta);
+
+        const auto curved = simdDivide((Shaper::antiderivative1(xBar)
+                                        + simdDivide(simdLoad<T>(ad1 + i) - Shaper::antiderivative2(xBar),
+                                                     safeDelta)) * 2.0,
+                                       safeDelta);
+
+        shaped = simdSelect(illConditioned,
+                            simdSelect(flat, Shaper::apply((xBar + mid) * 0.5), curved),
+                            shaped);
+      }
+
+      simdStore(shaped, wet + i);
+    });
+
+    mixADAAChunk<Shaper>(chunk, dry, wet, start, n, drive, mix, wetGain);
+
+    state.x2 = x1[n - 1];
+    state.x1 = x0[n - 1];
+    state.antiderivative = ad0[n - 1];
+    state.difference = d0[n - 1];
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::processMidSideBlock(juce::dsp::AudioBlock<SampleType>& block,
+                                                 const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                                                 const ParameterRamp& sideDrive, const ParameterRamp& sideMix,
+                                                 int clipType)
+{
+  // Only the first pair is encoded; the plugin never runs more than two.
+  auto* left = block.getChannelPointer(0);
+  auto* right = block.getChannelPointer(1);
+  const auto n = static_cast<int>(block.getNumSamples());
+
+  switch (clipType) {
+    case softClip:
+      processSoftClip(block, [&](auto& target, auto soft) {
+        processMidSideShaper<decltype(soft)>(target.getChannelPointer(0), target.getChannelPointer(1), n,
+                                             midDrive, midMix, sideDrive, sideMix,
+                                             m_wetGain, m_sideWetGain);
+      });
+      break;
+    case hardClip:
+      processMidSideShaper<HardClip>(left, right, n, midDrive, midMix, sideDrive, sideMix,
+                                     m_wetGain, m_sideWetGain);
+      break;
+    case softClipADAA1: processMidSideADAA<SoftClip, 1>(left, right, n, midDrive, midMix, sideDrive, sideMix); break;
+    case softClipADAA2: processMidSideADAA<SoftClip, 2>(left, right, n, midDrive, midMix, sideDrive, sideMix); break;
+    case hardClipADAA1: processMidSideADAA<HardClip, 1>(left, right, n, midDrive, midMix, sideDrive, sideMix); break;
+    case hardClipADAA2: processMidSideADAA<HardClip, 2>(left, right, n, midDrive, midMix, sideDrive, sideMix); break;
+    default:            jassertfalse; break;
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processMidSideShaper(SampleType* left, SampleType* right, int numSamples,
+                                                  const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                                                  const ParameterRamp& sideDrive, const ParameterRamp& sideMix,
+                                                  float midWetGain, float sideWetGain)
+{
+  if (midDrive.isConstant() && midMix.isConstant() && sideDrive.isConstant() && sideMix.isConstant()) {
+    const ShaperGains mid{ midDrive.value, 1.f - midMix.value, midWetGain };
+    const ShaperGains side{ sideDrive.value, 1.f - sideMix.value, sideWetGain };
+    processMidSide<Shaper>(left, right, numSamples, mid, side);
+  } else {
+    processMidSideRamped<Shaper>(left, right, numSamples, midDrive, midMix, sideDrive, sideMix);
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processMidSide(SampleType* left, SampleType* right, int numSamples,
+                                            const ShaperGains& mid, const ShaperGains& side)
+{
+  // Same walk as processStereo, with the encode and decode done in the
+  // registers so mid/side costs a few adds over plain stereo.
+  const auto head = getAlignmentOffset(left, numSamples);
+  const auto vectorStart = head == getAlignmentOffset(right, numSamples) ? head : numSamples;
+  int s = 0;
+
+  for (; s < vectorStart; ++s)
+    shapeMidSide<Shaper>(left[s], right[s], mid, side);
+
+  constexpr auto step = static_cast<int>(SIMDType::SIMDNumElements);
+
+  for (; s + step <= numSamples; s += step) {
+    auto l = SIMDType::fromRawArray(left + s);
+    auto r = SIMDType::fromRawArray(right + s);
+
+    shapeMidSide<Shaper>(l, r, mid, side);
+
+    l.copyToRawArray(left + s);
+    r.copyToRawArray(right + s);
+  }
+
+  for (; s < numSamples; ++s)
+    shapeMidSide<Shaper>(left[s], right[s], mid, side);
+}
+
+template <typename SampleType>
+template <typename Shaper>
+void Distortion<SampleType>::processMidSideRamped(SampleType* left, SampleType* right, int numSamples,
+                                                  const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                                                  const ParameterRamp& sideDrive, const ParameterRamp& sideMix)
+{
+  constexpr int chunkSize = 64;
+
+  ShaperGains mid[chunkSize];
+  ShaperGains side[chunkSize];
+
+  const auto gainsAt = [](const ParameterRamp& drive, const ParameterRamp& mix, int index) {
+    const auto m = mix[index];
+    return ShaperGains{ static_cast<SampleType>(drive[index]), static_cast<SampleType>(1.f - m),
+                        static_cast<SampleType>(getWetGain<Shaper>(drive[index], m)) };
+  };
+
+  for (int start = 0; start < numSamples; start += chunkSize) {
+    const auto n = juce::jmin(chunkSize, numSamples - start);
+
+    for (int i = 0; i < n; ++i) {
+      mid[i] = gainsAt(midDrive, midMix, start + i);
+      side[i] = gainsAt(sideDrive, sideMix, start + i);
+    }
+
+    for (int i = 0; i < n; ++i)
+      shapeMidSide<Shaper>(left[start + i], right[start + i], mid[i], side[i]);
+  }
+}
+
+template <typename SampleType>
+template <typename Shaper, int Order>
+void Distortion<SampleType>::processMidSideADAA(SampleType* left, SampleType* right, int numSamples,
+                                                const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                                                const ParameterRamp& sideDrive, const ParameterRamp& sideMix)
+{
+  // The ADAA kernels already stage each chunk through their own buffers, so
+  // here the encode and decode wrap them rather than living in their loops.
+  encodeMidSide(left, right, numSamples);
+
+  if constexpr (Order == 1) {
+    processADAA1<Shaper>(left, numSamples, m_adaaStates[0], midDrive, midMix, m_wetGain);
+    processADAA1<Shaper>(right, numSamples, m_adaaStates[1], sideDrive, sideMix, m_sideWetGain);
+  } else {
+    processADAA2<Shaper>(left, numSamples, m_adaaStates[0], midDrive, midMix, m_wetGain);
+    processADAA2<Shaper>(right, numSamples, m_adaaStates[1], sideDrive, sideMix, m_sideWetGain);
+  }
+
+  decodeMidSide(left, right, numSamples);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::encodeMidSide(SampleType* left, SampleType* right, int numSamples)
+{
+  for (int s = 0; s < numSamples; ++s) {
+    const auto l = left[s];
+    left[s] = (l + right[s]) * SampleType(0.5);
+    right[s] = (l - right[s]) * SampleType(0.5);
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::decodeMidSide(SampleType* left, SampleType* right, int numSamples)
+{
+  for (int s = 0; s < numSamples; ++s) {
+    const auto mid = left[s];
+    left[s] = mid + right[s];
+    right[s] = mid - right[s];
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::processBands(juce::dsp::AudioBlock<SampleType>& block,
+                                          const MultibandParameters& bands, int factorLog2)
+{
+  auto& crossover = m_crossovers[static_cast<size_t>(m_oversamplingIndex)];
+  const auto numChannels = static_cast<int>(block.getNumChannels());
+  const auto numSamples = static_cast<int>(block.getNumSamples());
+
+  auto isConstant = true;
+  auto hasSoft = false;
+  auto hasHard = false;
+
+  for (int b = 0; b < bands.numBands; ++b) {
+    const auto band = static_cast<size_t>(b);
+    isConstant = isConstant && bands.drive[band].isConstant() && bands.mix[band].isConstant();
+    hasSoft = hasSoft || bands.clipType[band] != hardClip;
+    hasHard = hasHard || bands.clipType[band] == hardClip;
+  }
+
+  // The crossover only writes the active bands; the rest stay silent, with
+  // zero gains, so every lane can go through the same arithmetic.
+  alignas(LaneAlignment) SampleType lanes[BandChunkSize * MaxBands] = {};
+  alignas(LaneAlignment) SampleType previousLanes[BandChunkSize * MaxBands];
+  LaneGains gains;
+
+  // The crossover can't run twice, so while a Quality change settles the
+  // split bands also go through the old curve on a copy, and the two sums
+  // are crossfaded per sample.
+  const auto* blend = hasSoft ? getQualityBlend(numSamples) : nullptr;
 
-      data[s] = dry * dryGain
-        + ((clipType == 0)
-          ? fastTanh(driven)
-          : std::clamp(driven, -1.f, 1.f))
-        * wetGain;
+  if (isConstant)
+    fillLaneGains(gains, bands, factorLog2, 0, BandChunkSize);
+
+  for (int start = 0; start < numSamples; start += BandChunkSize) {
+    const auto n = juce::jmin(BandChunkSize, numSamples - start);
+    const auto count = n * MaxBands;
+
+    if (! isConstant)
+      fillLaneGains(gains, bands, factorLog2, start, n);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      auto* data = block.getChannelPointer(static_cast<size_t>(ch)) + start;
+
+      for (int i = 0; i < n; ++i)
+        crossover.split(ch, data[i], lanes + i * MaxBands);
+
+      if (blend != nullptr) {
+        std::copy(lanes, lanes + count, previousLanes);
+        withSoftClip(m_previousQuality, [&](auto soft) {
+          shapeBands<decltype(soft)>(previousLanes, gains, count, hasSoft, hasHard);
+        });
+      }
+
+      withSoftClip(m_quality, [&](auto soft) {
+        shapeBands<decltype(soft)>(lanes, gains, count, hasSoft, hasHard);
+      });
+
+      for (int i = 0; i < n; ++i) {
+        const auto* lane = lanes + i * MaxBands;
+        data[i] = (lane[0] + lane[1]) + (lane[2] + lane[3]);
+
+        if (blend != nullptr) {
+          const auto* previousLane = previousLanes + i * MaxBands;
+          const auto old = (previousLane[0] + previousLane[1]) + (previousLane[2] + previousLane[3]);
+          data[i] = old + (data[i] - old) * blend[start + i];
+        }
+      }
     }
   }
 }
+
+template <typename SampleType>
+template <typename Soft>
+void Distortion<SampleType>::shapeBands(SampleType* lanes, const LaneGains& gains, int count,
+                                        bool hasSoft, bool hasHard)
+{
+  if (! hasHard) {
+    shapeLanes(lanes, gains, count, [](auto driven, int, const LaneGains&) {
+      return Soft::apply(driven);
+    });
+  } else if (! hasSoft) {
+    shapeLanes(lanes, gains, count, [](auto driven, int, const LaneGains&) {
+      return HardClip::apply(driven);
+    });
+  } else {
+    shapeLanes(lanes, gains, count, [](auto driven, int i, const LaneGains& laneGains) {
+      using T = decltype(driven);
+      const auto soft = simdLessThan(simdLoad<T>(laneGains.hard + i), simdBroadcast<T>(0.5));
+      return simdSelect(soft, Soft::apply(driven), HardClip::apply(driven));
+    });
+  }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::fillLaneGains(LaneGains& gains, const MultibandParameters& bands,
+                                           int factorLog2, int start, int numSamples)
+{
+  for (int b = 0; b < MaxBands; ++b) {
+    const auto band = static_cast<size_t>(b);
+    const auto isActive = b < bands.numBands;
+    const auto isHard = bands.clipType[band] == hardClip;
+    const auto drive = bands.drive[band].withOversampling(factorLog2);
+    const auto mix = bands.mix[band].withOversampling(factorLog2);
+
+    const auto getWet = [isActive, isHard](float d, float m) {
+      return ! isActive ? SampleType(0)
+             : isHard   ? static_cast<SampleType>(getWetGain<HardClip>(d, m))
+                        : static_cast<SampleType>(getWetGain<SoftClip>(d, m));
+    };
+
+    // A band holding still needs its std::pow only once.
+    const auto isBandConstant = drive.isConstant() && mix.isConstant();
+    const auto constantWet = isBandConstant ? getWet(drive.value, mix.value) : SampleType(0);
+
+    for (int i = 0; i < numSamples; ++i) {
+      const auto lane = i * MaxBands + b;
+      const auto d = drive[start + i];
+      const auto m = mix[start + i];
+
+      gains.drive[lane] = isActive ? static_cast<SampleType>(d) : SampleType(0);
+      gains.dry[lane] = isActive ? static_cast<SampleType>(1.f - m) : SampleType(0);
+      gains.wet[lane] = isBandConstant ? constantWet : getWet(d, m);
+      gains.hard[lane] = isHard ? SampleType(1) : SampleType(0);
+    }
+  }
+}
+
+template <typename SampleType>
+template <typename Shape>
+void Distortion<SampleType>::shapeLanes(SampleType* lanes, const LaneGains& gains, int count,
+                                        Shape&& shape)
+{
+  // Each register holds neighbouring bands of one sample, so the bands are
+  // shaped side by side rather than in one pass each.
+  simdForEach<SampleType>(count, [&](int i, auto lane) {
+    using T = decltype(lane);
+
+    const auto dry = simdLoad<T>(lanes + i);
+    const auto shaped = shape(dry * simdLoad<T>(gains.drive + i), i, gains);
+
+    simdStore(dry * simdLoad<T>(gains.dry + i) + shaped * simdLoad<T>(gains.wet + i), lanes + i);
+  });
+}
+
+template class Distortion<float>;
+template class Distortion<double>;
@@ -1,18 +1,432 @@
 #pragma once
 #include <JuceHeader.h>
+#include "Crossover.h"
+#include "ParameterRamp.h"
+#include "Quality.h"
+#include "SIMDHelpers.h"
+#include "StereoParameters.h"
 
+// Per-band settings for Distortion::processMultiband(). Bands pick between
+// the plain soft and hard clip curves, which can differ from lane to lane.
+struct MultibandParameters
+{
+  static constexpr int MaxBands = 4;
+
+  int numBands = 1;
+  std::array<float, MaxBands - 1> crossovers{};
+  std::array<ParameterRamp, MaxBands> drive, mix;
+  std::array<int, MaxBands> clipType{};
+};
+
+// Instantiated for float and double processing; the antiderivative kernels
+// work in double either way.
+template <typename SampleType>
 class Distortion
 {
 public:
-  void process(juce::AudioBuffer<float>& buffer, float drive,
-               float mix, int clipType);
+  static constexpr int NumOversamplingFactors = 4;
+
+  void prepare(const juce::dsp::ProcessSpec& spec);
+  void reset();
+  // gainChanged tells the stage drive, mix, clipType or the stereo settings
+  // moved since the last call, so the cached wet gains have to be worked out
+  // again.
+  void process(juce::dsp::AudioBlock<SampleType>& block, const ParameterRamp& drive,
+               const ParameterRamp& mix, int clipType, const StereoParameters& stereo,
+               bool gainChanged);
+
+  // Splits the block into Linkwitz-Riley bands and shapes them together, one
+  // band per SIMD lane, before summing them back up. The band settings apply
+  // to mid and side alike.
+  void processMultiband(juce::dsp::AudioBlock<SampleType>& block,
+                        const MultibandParameters& bands, const StereoParameters& stereo,
+                        bool crossoversChanged);
+
+  // factorIndex selects 1x/2x/4x/8x; linearPhase picks the FIR half-band
+  // cascade over the low-latency polyphase IIR one.
+  void setOversampling(int factorIndex, bool linearPhase);
+  int getLatencySamples() const;
+
+  // Picks the plain soft clip curve: lower order at Eco, higher at High.
+  // Once the stage is running, a change blends from the old curve to the
+  // new one over Quality::blendSeconds instead of switching on a sample.
+  void setQuality(Quality::Level quality);
+
+  // One sample at a time through the plain soft or hard clip, at 1x; the
+  // reference SkuxBenchmark --verify holds the vectorised kernels to.
+  void processScalar(juce::dsp::AudioBlock<SampleType>& block, float drive, float mix, int clipType);
 
 private:
-  static inline float fastTanh(float value)
+  using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+  using Oversampler = juce::dsp::Oversampling<SampleType>;
+
+  enum ClipType
   {
-    value = std::clamp(value, -5.f, 5.f);
-    const float v2 = value * value;
-    return value * (945.f + v2 * (105.f + v2))
-           / (945.f + v2 * (420.f + v2 * 15.f));
+    softClip = 0,
+    hardClip,
+    softClipADAA1,
+    softClipADAA2,
+    hardClipADAA1,
+    hardClipADAA2
+  };
+
+  struct SoftClip
+  {
+    static constexpr float gainExponent = 0.45f;
+
+    template <typename T>
+    static T apply(T value) { return fastTanh(value); }
+
+    // SIMDRegister has no log1p or atan, so these two go a lane at a time.
+    template <typename T>
+    static T antiderivative1(T value)
+    {
+      return simdPerLane(value, [](double x) { return firstAntiderivative(x); });
+    }
+
+    template <typename T>
+    static T antiderivative2(T value)
+    {
+      return simdPerLane(value, [](double x) { return secondAntiderivative(x); });
+    }
+
+    // fastTanh split into partial fractions in u = x^2:
+    // 1/15 + A / (u + a) + B / (u + b), with a, b = 14 -/+ sqrt(133).
+    static constexpr double a = 2.4674374053292034;
+    static constexpr double b = 25.532562594670797;
+    static constexpr double sqrtA = 1.5708078830109058;
+    static constexpr double sqrtB = 5.0529756178583325;
+    static constexpr double weightA = 2.0001548199109083;
+    static constexpr double weightB = 3.133178513422425;
+
+    // Values at the +/-5 input clamp, past which the curve is flat.
+    static constexpr double edgeValue = 1.0074447646493756;
+    static constexpr double edgeAntiderivative1 = 4.312794001052266;
+    static constexpr double edgeAntiderivative2 = 9.449268466139724;
+
+    static double firstAntiderivative(double x)
+    {
+      const auto ax = std::abs(x);
+
+      if (ax > 5.0)
+        return edgeAntiderivative1 + edgeValue * (ax - 5.0);
+
+      const auto u = x * x;
+      return 0.5 * (u / 15.0 + weightA * std::log1p(u / a) + weightB * std::log1p(u / b));
+    }
+
+    static double secondAntiderivative(double x)
+    {
+      const auto ax = std::abs(x);
+      double result;
+
+      if (ax > 5.0) {
+        const auto over = ax - 5.0;
+        result = edgeAntiderivative2 + edgeAntiderivative1 * over + edgeValue * over * over * 0.5;
+      } else {
+        // Integral of log(1 + t^2 / c) from 0 to x.
+        const auto logIntegral = [ax](double c, double sqrtC) {
+          return ax * std::log1p(ax * ax / c) - 2.0 * ax + 2.0 * sqrtC * std::atan(ax / sqrtC);
+        };
+
+        result = 0.5 * (ax * ax * ax / 45.0
+                        + weightA * logIntegral(a, sqrtA)
+                        + weightB * logIntegral(b, sqrtB));
+      }
+
+      return std::copysign(result, x);
+    }
+  };
+
+  // Cheaper and more exact stand-ins for SoftClip::apply. Only the plain
+  // soft clip uses them; the ADAA kernels are built around fastTanh.
+  struct EcoSoftClip
+  {
+    static constexpr float gainExponent = SoftClip::gainExponent;
+
+    // x (27 + x^2) / (27 + 9 x^2) meets +/-1 with zero slope at +/-3.
+    template <typename T>
+    static T apply(T value)
+    {
+      using E = SIMDElementType<T>;
+
+      value = simdClamp(value, -3.0, 3.0);
+      const auto v2 = value * value;
+      return simdDivide(value * (v2 + E(27)), v2 * E(9) + E(27));
+    }
+  };
+
+  struct HighSoftClip
+  {
+    static constexpr float gainExponent = SoftClip::gainExponent;
+
+    // [7/6] Pade approximant of tanh: within 1.5e-5 of it up to |x| = 4,
+    // drifting to 1e-4 off, and 1e-5 past 1, at the +/-5 clamp.
+    template <typename T>
+    static T apply(T value)
+    {
+      using E = SIMDElementType<T>;
+
+      value = simdClamp(value, -5.0, 5.0);
+      const auto v2 = value * value;
+      return simdDivide(value * (((v2 + E(378)) * v2 + E(17325)) * v2 + E(135135)),
+                        ((v2 * E(28) + E(3150)) * v2 + E(62370)) * v2 + E(135135));
+    }
+  };
+
+  struct HardClip
+  {
+    static constexpr float gainExponent = 0.6f;
+
+    template <typename T>
+    static T apply(T value) { return simdClamp(value, -1.0, 1.0); }
+
+    template <typename T>
+    static T antiderivative1(T value)
+    {
+      using E = SIMDElementType<T>;
+      const auto ax = simdAbs(value);
+
+      return simdSelect(simdLessThan(ax, simdBroadcast<T>(1.0)),
+                        value * value * E(0.5),
+                        ax - E(0.5));
+    }
+
+    template <typename T>
+    static T antiderivative2(T value)
+    {
+      using E = SIMDElementType<T>;
+      const auto zero = simdBroadcast<T>(0.0);
+      const auto outer = value * value * E(0.5) + E(1.0 / 6.0);
+      const auto signedOuter = simdSelect(simdLessThan(value, zero), zero - outer, outer);
+
+      return simdSelect(simdLessThan(simdAbs(value), simdBroadcast<T>(1.0)),
+                        value * value * value * E(1.0 / 6.0),
+                        signedOuter - value * E(0.5));
+    }
+  };
+
+  // Per-channel history for the antiderivative-antialiased shapers.
+  struct ADAAState
+  {
+    double x1 = 0.0;
+    double x2 = 0.0;
+    double antiderivative = 0.0;
+    double difference = 0.0;
+  };
+
+  // Below this input step the divided differences lose precision, and the
+  // kernels fall back to evaluating the curve at the midpoint instead.
+  static constexpr double ADAATolerance = 1.0e-5;
+  static constexpr int ADAAChunkSize = 64;
+
+  static constexpr int MaxBands = MultibandParameters::MaxBands;
+  static constexpr int BandChunkSize = 16;
+  static constexpr auto LaneAlignment = SIMDType::SIMDRegisterSize;
+
+  static_assert(MaxBands == Crossover<SampleType>::MaxBands);
+
+  // Per-lane gains for a chunk of band samples, laid out like the lanes:
+  // band b of sample i sits at i * MaxBands + b.
+  struct LaneGains
+  {
+    alignas(LaneAlignment) SampleType drive[BandChunkSize * MaxBands];
+    alignas(LaneAlignment) SampleType dry[BandChunkSize * MaxBands];
+    alignas(LaneAlignment) SampleType wet[BandChunkSize * MaxBands];
+    alignas(LaneAlignment) SampleType hard[BandChunkSize * MaxBands];
+  };
+
+  // Drive, dry and wet gain of one channel for the fused mid/side kernels.
+  struct ShaperGains
+  {
+    SampleType drive, dry, wet;
+  };
+
+  template <typename Function>
+  void processOversampled(juce::dsp::AudioBlock<SampleType>& block, bool isMuted, Function&& function);
+
+  void processBlock(juce::dsp::AudioBlock<SampleType>& block, const ParameterRamp& drive,
+                    const ParameterRamp& mix, int clipType);
+  void processBands(juce::dsp::AudioBlock<SampleType>& block, const MultibandParameters& bands,
+                    int factorLog2);
+
+  template <typename Soft>
+  static void shapeBands(SampleType* lanes, const LaneGains& gains, int count, bool hasSoft, bool hasHard);
+
+  // Calls function with the soft clip shaper for a quality.
+  template <typename Function>
+  static void withSoftClip(Quality::Level quality, Function&& function)
+  {
+    switch (quality) {
+      case Quality::eco:  function(EcoSoftClip{}); break;
+      case Quality::high: function(HighSoftClip{}); break;
+      default:            function(SoftClip{}); break;
+    }
+  }
+
+  // Calls function(block, shaper) with the soft clip for the current
+  // quality, crossfaded per sample from the previous one while it settles.
+  template <typename Function>
+  void processSoftClip(juce::dsp::AudioBlock<SampleType>& block, Function&& function);
+
+  // Per-sample weights of the new curve for the next numSamples of the
+  // (possibly oversampled) block, or nullptr once the blend is done.
+  const SampleType* getQualityBlend(int numSamples);
+  void advanceQualityBlend(int numSamples);
+
+  static void fillLaneGains(LaneGains& gains, const MultibandParameters& bands, int factorLog2,
+                            int start, int numSamples);
+
+  template <typename Shape>
+  static void shapeLanes(SampleType* lanes, const LaneGains& gains, int count, Shape&& shape);
+
+  void processMidSideBlock(juce::dsp::AudioBlock<SampleType>& block,
+                           const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                           const ParameterRamp& sideDrive, const ParameterRamp& sideMix,
+                           int clipType);
+
+  template <typename Shaper>
+  static void processMidSideShaper(SampleType* left, SampleType* right, int numSamples,
+                                   const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                                   const ParameterRamp& sideDrive, const ParameterRamp& sideMix,
+                                   float midWetGain, float sideWetGain);
+
+  template <typename Shaper>
+  static void processMidSide(SampleType* left, SampleType* right, int numSamples,
+                             const ShaperGains& mid, const ShaperGains& side);
+
+  template <typename Shaper>
+  static void processMidSideRamped(SampleType* left, SampleType* right, int numSamples,
+                                   const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                                   const ParameterRamp& sideDrive, const ParameterRamp& sideMix);
+
+  template <typename Shaper, int Order>
+  void processMidSideADAA(SampleType* left, SampleType* right, int numSamples,
+                          const ParameterRamp& midDrive, const ParameterRamp& midMix,
+                          const ParameterRamp& sideDrive, const ParameterRamp& sideMix);
+
+  // Encodes left/right into mid/side, shapes both and decodes in place, for
+  // scalars and SIMD registers alike.
+  template <typename Shaper, typename T>
+  static void shapeMidSide(T& left, T& right, const ShaperGains& mid, const ShaperGains& side)
+  {
+    const auto m = (left + right) * SampleType(0.5);
+    const auto s = (left - right) * SampleType(0.5);
+    const auto midOut = m * mid.dry + Shaper::apply(m * mid.drive) * mid.wet;
+    const auto sideOut = s * side.dry + Shaper::apply(s * side.drive) * side.wet;
+
+    left = midOut + sideOut;
+    right = midOut - sideOut;
+  }
+
+  static void encodeMidSide(SampleType* left, SampleType* right, int numSamples);
+  static void decodeMidSide(SampleType* left, SampleType* right, int numSamples);
+
+  template <typename Shaper>
+  static void processShaper(juce::dsp::AudioBlock<SampleType>& block,
+                            const ParameterRamp& drive, const ParameterRamp& mix, float wetGain);
+
+  template <typename Shaper>
+  static void processChannels(juce::dsp::AudioBlock<SampleType>& block, float drive, float mix,
+                              float wetGain);
+
+  template <typename Shaper>
+  static void processRamped(juce::dsp::AudioBlock<SampleType>& block,
+                            const ParameterRamp& drive, const ParameterRamp& mix);
+
+  template <typename Shaper>
+  static void processStereo(SampleType* left, SampleType* right, int numSamples,
+                            SampleType drive, SampleType dryGain, SampleType wetGain);
+
+  template <typename Shaper>
+  static void processMono(SampleType* data, int numSamples,
+                          SampleType drive, SampleType dryGain, SampleType wetGain);
+
+  template <typename Shaper, int Order>
+  void processADAA(juce::dsp::AudioBlock<SampleType>& block,
+                   const ParameterRamp& drive, const ParameterRamp& mix, float wetGain);
+
+  // Brings the stored antiderivatives in line with a new ADAA curve or order,
+  // keeping the input history, so a Type change doesn't click.
+  void rebaseADAAStates(int clipType);
+
+  template <typename Shaper, int Order>
+  void rebaseADAAStates(bool keepHistory);
+
+  template <typename Shaper>
+  static void processADAA1(SampleType* data, int numSamples, ADAAState& state,
+                           const ParameterRamp& drive, const ParameterRamp& mix, float wetGain);
+
+  template <typename Shaper>
+  static void processADAA2(SampleType* data, int numSamples, ADAAState& state,
+                           const ParameterRamp& drive, const ParameterRamp& mix, float wetGain);
+
+  template <typename Shaper>
+  static void mixADAAChunk(SampleType* data, const double* dry, const double* wet, int offset,
+                           int numSamples, const ParameterRamp& drive, const ParameterRamp& mix,
+                           float wetGain);
+
+  // Drive raises the shaper's output level, so the wet path is scaled back
+  // down by a per-curve power of the drive.
+  template <typename Shaper>
+  static float getWetGain(float drive, float mix)
+  {
+    return mix / std::pow(drive, Shaper::gainExponent);
+  }
+
+  static float getWetGain(int clipType, float drive, float mix)
+  {
+    const auto isSoft = clipType == softClip || clipType == softClipADAA1 || clipType == softClipADAA2;
+    return isSoft ? getWetGain<SoftClip>(drive, mix) : getWetGain<HardClip>(drive, mix);
+  }
+
+  static int getAlignmentOffset(SampleType* data, int numSamples)
+  {
+    return juce::jmin(numSamples,
+                      static_cast<int>(SIMDType::getNextSIMDAlignedPtr(data) - data));
+  }
+
+  Oversampler* getActiveOversampler() const;
+
+  // One oversampler per factor above 1x, for each filter type, all built in
+  // prepare() so switching never allocates on the audio thread.
+  std::array<std::unique_ptr<Oversampler>, NumOversamplingFactors - 1> m_iirOversamplers;
+  std::array<std::unique_ptr<Oversampler>, NumOversamplingFactors - 1> m_firOversamplers;
+  int m_oversamplingIndex = 0;
+  bool m_linearPhase = false;
+
+  std::vector<ADAAState> m_adaaStates;
+  int m_adaaClipType = softClip;
+  Quality::Level m_quality = Quality::normal;
+
+  // The blend counts host-rate samples, so it lasts as long at any
+  // oversampling factor. The buffers hold one block at 8x.
+  Quality::Level m_previousQuality = Quality::normal;
+  int m_qualityBlendLength = 0;
+  int m_qualityBlendPosition = 0;
+  bool m_isRunning = false;
+  juce::AudioBuffer<SampleType> m_qualityBlendBuffer;
+  std::vector<SampleType> m_qualityBlend;
+
+  // One crossover per oversampling factor, each prepared for its own rate.
+  std::array<Crossover<SampleType>, NumOversamplingFactors> m_crossovers;
+  bool m_crossoversValid = false;
+
+  // Wet gains for constant drive and mix; ramped blocks work them out per
+  // sample. The side one is only used in the mid/side modes.
+  float m_wetGain = 0.f;
+  bool m_wetGainValid = false;
+  float m_sideWetGain = 0.f;
+  bool m_sideWetGainValid = false;
+
+  template <typename T>
+  static inline T fastTanh(T value)
+  {
+    using E = SIMDElementType<T>;
+
+    value = simdClamp(value, -5.0, 5.0);
+    const auto v2 = value * value;
+    return simdDivide(value * ((v2 + E(105)) * v2 + E(945)),
+                      (v2 * E(15) + E(420)) * v2 + E(945));
   }
 };
@@ -0,0 +1,121 @@
+#include "DspLoadMonitor.h"
+
+DspLoadMonitor::DspLoadMonitor()
+{
+  m_nsPerTick = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+}
+
+void DspLoadMonitor::prepare(double sampleRate)
+{
+  m_sampleRate = sampleRate;
+  reset();
+}
+
+void DspLoadMonitor::reset()
+{
+  for (auto& stats : m_stages) {
+    for (auto& bucket : stats.histogram)
+      bucket.store(0, std::memory_order_relaxed);
+
+    stats.count.store(0, std::memory_order_relaxed);
+    stats.totalNs.store(0, std::memory_order_relaxed);
+    stats.maxNs.store(0, std::memory_order_relaxed);
+  }
+
+  m_load.store(0.f, std::memory_order_relaxed);
+  m_peakLoad.store(0.f, std::memory_order_relaxed);
+  m_numOverruns.store(0, std::memory_order_relaxed);
+}
+
+void DspLoadMonitor::record(Stage stage, juce::int64 ticks)
+{
+  auto& stats = m_stages[static_cast<size_t>(stage)];
+  const auto ns = ticksToNs(ticks);
+
+  int bucket = 0;
+  for (auto bound = juce::uint64(1) << (MinBucketLog2 + 1); ns >= bound && bucket < NumBuckets - 1; bound <<= 1)
+    ++bucket;
+
+  increment(stats.histogram[static_cast<size_t>(bucket)]);
+  increment(stats.count);
+  increment(stats.totalNs, ns);
+
+  if (ns > stats.maxNs.load(std::memory_order_relaxed))
+    stats.maxNs.store(ns, std::memory_order_relaxed);
+}
+
+void DspLoadMonitor::finishBlock(juce::int64 blockTicks, int numSamples)
+{
+  record(wholeBlock, blockTicks);
+
+  if (numSamples <= 0)
+    return;
+
+  const auto deadlineNs = 1.0e9 * numSamples / m_sampleRate;
+  const auto load = static_cast<float>(static_cast<double>(ticksToNs(blockTicks)) / deadlineNs);
+
+  m_load.store(load, std::memory_order_relaxed);
+
+  if (load > m_peakLoad.load(std::memory_order_relaxed))
+    m_peakLoad.store(load, std::memory_order_relaxed);
+
+  if (load >= 1.f)
+    increment(m_numOverruns);
+}
+
+juce::String DspLoadMonitor::getStageName(Stage stage)
+{
+  switch (stage) {
+    case preFilter:  return "preFilter";
+    case distortion: return "distortion";
+    case cabinet:    return "cabinet";
+    case postFilter: return "postFilter";
+    case scopePush:  return "scopePush";
+    case wholeBlock: return "processBlock";
+    case NumStages:  break;
+  }
+
+  return {};
+}
+
+double DspLoadMonitor::getBucketUpperBoundNs(int bucket)
+{
+  return std::ldexp(1.0, bucket + MinBucketLog2 + 1);
+}
+
+juce::var DspLoadMonitor::toVar() const
+{
+  auto* root = new juce::DynamicObject();
+  juce::Array<juce::var> stages;
+
+  for (int i = 0; i < NumStages; ++i) {
+    const auto& stats = m_stages[static_cast<size_t>(i)];
+    const auto count = stats.count.load(std::memory_order_relaxed);
+    const auto totalNs = stats.totalNs.load(std::memory_order_relaxed);
+
+    auto* stage = new juce::DynamicObject();
+    stage->setProperty("name", getStageName(static_cast<Stage>(i)));
+    stage->setProperty("count", static_cast<juce::int64>(count));
+    stage->setProperty("meanNs", count > 0 ? static_cast<double>(totalNs) / static_cast<double>(count) : 0.0);
+    stage->setProperty("maxNs", static_cast<juce::int64>(stats.maxNs.load(std::memory_order_relaxed)));
+
+    juce::Array<juce::var> histogram;
+
+    for (int b = 0; b < NumBuckets; ++b) {
+      auto* bucket = new juce::DynamicObject();
+      bucket->setProperty("upperNs", getBucketUpperBoundNs(b));
+      bucket->setProperty("count", static_cast<juce::int64>(stats.histogram[static_cast<size_t>(b)]
+                                                              .load(std::memory_order_relaxed)));
+      histogram.add(juce::var(bucket));
+    }
+
+    stage->setProperty("histogram", histogram);
+    stages.add(juce::var(stage));
+  }
+
+  root->setProperty("sampleRate", m_sampleRate);
+  root->setProperty("load", getLoad());
+  root->setProperty("overruns", static_cast<juce::int64>(getNumOverruns()));
+  root->setProperty("stages", stages);
+  return juce::var(root);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Per-stage wall-clock timings of processBlock. The audio thread only does
+// relaxed atomic loads and stores into fixed-size histograms, so recording
+// never locks or allocates; the GUI and export paths read them concurrently.
+class DspLoadMonitor
+{
+public:
+  enum Stage
+  {
+    preFilter = 0,
+    distortion,
+    cabinet,
+    postFilter,
+    scopePush,
+    wholeBlock,
+    NumStages
+  };
+
+  // Bucket i counts blocks that took [2^(i + MinBucketLog2), 2^(i + 1 + MinBucketLog2)) ns.
+  static constexpr int NumBuckets = 24;
+  static constexpr int MinBucketLog2 = 8;
+
+  class ScopedStage
+  {
+  public:
+    ScopedStage(DspLoadMonitor& monitor, Stage stage)
+      : m_monitor(monitor), m_stage(stage), m_start(juce::Time::getHighResolutionTicks()) {}
+
+    ~ScopedStage() { m_monitor.record(m_stage, juce::Time::getHighResolutionTicks() - m_start); }
+
+  private:
+    DspLoadMonitor& m_monitor;
+    Stage m_stage;
+    juce::int64 m_start;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+  };
+
+  DspLoadMonitor();
+
+  void prepare(double sampleRate);
+  void reset();
+
+  void record(Stage stage, juce::int64 ticks);
+  void finishBlock(juce::int64 blockTicks, int numSamples);
+
+  // Fraction of the buffer deadline used by the most recent block.
+  float getLoad() const { return m_load.load(std::memory_order_relaxed); }
+
+  // Highest load since the previous call; meant for a single GUI reader.
+  float takePeakLoad() { return m_peakLoad.exchange(0.f, std::memory_order_relaxed); }
+
+  juce::uint64 getNumOverruns() const { return m_numOverruns.load(std::memory_order_relaxed); }
+
+  static juce::String getStageName(Stage stage);
+  static double getBucketUpperBoundNs(int bucket);
+
+  juce::var toVar() const;
+  juce::String exportJSON() const { return juce::JSON::toString(toVar()); }
+
+private:
+  struct StageStats
+  {
+    std::array<std::atomic<juce::uint64>, NumBuckets> histogram{};
+    std::atomic<juce::uint64> count{ 0 };
+    std::atomic<juce::uint64> totalNs{ 0 };
+    std::atomic<juce::uint64> maxNs{ 0 };
+  };
+
+  // Only the audio thread writes, so a load/store pair is enough and avoids
+  // a locked read-modify-write on every sample block.
+  static void increment(std::atomic<juce::uint64>& counter, juce::uint64 amount = 1)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  juce::uint64 ticksToNs(juce::int64 ticks) const
+  {
+    return static_cast<juce::uint64>(juce::jmax(0.0, static_cast<double>(ticks) * m_nsPerTick));
+  }
+
+  std::array<StageStats, NumStages> m_stages;
+  std::atomic<float> m_load{ 0.f };
+  std::atomic<float> m_peakLoad{ 0.f };
+  std::atomic<juce::uint64> m_numOverruns{ 0 };
+  double m_nsPerTick = 1.0;
+  double m_sampleRate = 44100.0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspLoadMonitor)
+};
@@ -1,53 +1,226 @@
 #include "Filter.h"
 
-void Filter::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void Filter<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-  m_sampleRate = spec.sampleRate;
-  m_filterMixBuffer.setSize(static_cast<int>(spec.numChannels),
-                            static_cast<int>(spec.maximumBlockSize));
-  m_filter.prepare(spec);
+  const auto sampleRate = static_cast<SampleType>(spec.sampleRate);
+
+  m_piOverSampleRate = juce::MathConstants<SampleType>::pi / sampleRate;
+  m_maxCutoff = SampleType(0.49) * sampleRate;
+  m_states.resize((spec.numChannels + 1) / 2);
+  m_warpingBlendLength = juce::roundToInt(spec.sampleRate * Quality::blendSeconds);
+  m_coefficientsValid = false;
+  reset();
 }
 
-void Filter::reset()
+template <typename SampleType>
+void Filter<SampleType>::reset()
 {
-  m_filter.reset();
-  m_lastFilterCutoff = -1.f;
-  m_lastFilterQ = -1.f;
+  const auto zero = SIMDType::expand(0);
+
+  for (auto& pair : m_states) {
+    for (auto& stage : pair)
+      stage = { zero, zero };
+  }
+
+  m_warpingBlendRemaining = 0;
+  m_isRunning = false;
+  m_coefficientsValid = false;
 }
 
-void Filter::process(juce::AudioBuffer<float>& buffer, float cutoff, float q, float mix)
+template <typename SampleType>
+void Filter<SampleType>::setQuality(Quality::Level quality)
 {
-  const auto numChannels = buffer.getNumChannels();
-  const auto numSamples = buffer.getNumSamples();
+  const auto exactWarping = quality == Quality::high;
 
-  if (cutoff != m_lastFilterCutoff || q != m_lastFilterQ) {
-    *m_filter.get<0>().state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(m_sampleRate, cutoff, q);
-    *m_filter.get<1>().state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(m_sampleRate, cutoff, 0.707f);
+  // A filter that has not run since prepare() or reset() switches right
+  // away; a blend still under way turns back from where it got to.
+  if (exactWarping != m_exactWarping) {
+    m_exactWarping = exactWarping;
+    m_warpingBlendRemaining = m_isRunning ? m_warpingBlendLength - m_warpingBlendRemaining : 0;
+    m_coefficientsValid = false;
+  }
+
+  m_coefficientInterval = quality == Quality::eco ? EcoCoefficientInterval : 1;
+}
 
-    m_lastFilterCutoff = cutoff;
-    m_lastFilterQ = q;
+template <typename SampleType>
+typename Filter<SampleType>::Coefficients Filter<SampleType>::makeCoefficients(SampleType g, SampleType sideG,
+                                                                               SampleType k)
+{
+  const auto makeLane = [k](SampleType laneG) {
+    const auto a1 = SampleType(1) / (SampleType(1) + laneG * (laneG + k));
+    return std::array<SampleType, 3>{ a1, laneG * a1, laneG * laneG * a1 };
+  };
+
+  const auto mid = makeLane(g);
+  Coefficients coeffs{ SIMDType::expand(mid[0]), SIMDType::expand(mid[1]),
+                       SIMDType::expand(mid[2]), SIMDType::expand(k) };
+
+  // Lane 1 carries the side channel in the mid/side modes.
+  if (sideG != g) {
+    const auto side = makeLane(sideG);
+    coeffs.a1.set(1, side[0]);
+    coeffs.a2.set(1, side[1]);
+    coeffs.a3.set(1, side[2]);
   }
 
-  juce::dsp::AudioBlock<float> block(buffer);
-  juce::dsp::ProcessContextReplacing<float> context(block);
+  return coeffs;
+}
+
+template <typename SampleType>
+SampleType Filter<SampleType>::getExactShare(int numSamples) const
+{
+  const auto remaining = juce::jmax(0, m_warpingBlendRemaining - numSamples);
+
+  if (remaining == 0)
+    return m_exactWarping ? SampleType(1) : SampleType(0);
+
+  const auto old = static_cast<SampleType>(remaining) / static_cast<SampleType>(m_warpingBlendLength);
+  return m_exactWarping ? SampleType(1) - old : old;
+}
+
+template <typename SampleType>
+SampleType Filter<SampleType>::getWarpedCutoff(SampleType cutoff, SampleType exactShare) const
+{
+  const auto x = juce::jmin(cutoff, m_maxCutoff) * m_piOverSampleRate;
+
+  if (exactShare <= SampleType(0))
+    return fastTan(x);
+
+  if (exactShare >= SampleType(1))
+    return std::tan(x);
+
+  const auto fast = fastTan(x);
+  return fast + (std::tan(x) - fast) * exactShare;
+}
+
+template <typename SampleType>
+void Filter<SampleType>::updateCoefficients(SampleType cutoff, SampleType sideCutoff, SampleType q,
+                                            SampleType exactShare)
+{
+  const auto g = getWarpedCutoff(cutoff, exactShare);
+  const auto sideG = sideCutoff == cutoff ? g : getWarpedCutoff(sideCutoff, exactShare);
+
+  m_stage1 = makeCoefficients(g, sideG, SampleType(1) / q);
+  m_stage2 = makeCoefficients(g, sideG, juce::MathConstants<SampleType>::sqrt2);
+  m_coefficientsValid = true;
+}
+
+template <typename SampleType>
+void Filter<SampleType>::process(juce::dsp::AudioBlock<SampleType>& block, const ParameterRamp& cutoff,
+                                 const ParameterRamp& q, const ParameterRamp& mix,
+                                 const StereoParameters& stereo, int response, int slope,
+                                 bool coefficientsChanged)
+{
+  const auto steep = slope == slope24dB;
+  const auto midSide = stereo.isMidSide() && block.getNumChannels() >= 2;
+
+  const PairParameters params = midSide
+    ? PairParameters{ cutoff, stereo.sideCutoff, q, stereo.getMidMix(mix), stereo.getSideMix() }
+    : PairParameters{ cutoff, cutoff, q, mix, mix };
 
-  if (mix >= 1.f) {
-    m_filter.process(context);
-    return;
+  // Modulated blocks, and blocks a warping blend runs through, rebuild the
+  // coefficients per sample in processPair.
+  const auto isRewarping = m_warpingBlendRemaining > 0;
+
+  if (! isRewarping && params.cutoff.isConstant() && params.sideCutoff.isConstant() && q.isConstant()
+      && (coefficientsChanged || ! m_coefficientsValid))
+    updateCoefficients(params.cutoff.value, params.sideCutoff.value, q.value, getExactShare(0));
+
+  switch (response) {
+    case highPass: processResponse<highPass>(block, params, steep, midSide); break;
+    case lowPass:  processResponse<lowPass>(block, params, steep, midSide); break;
+    case bandPass: processResponse<bandPass>(block, params, steep, midSide); break;
+    case notch:    processResponse<notch>(block, params, steep, midSide); break;
+    default:       jassertfalse; break;
   }
 
-  for (int ch = 0; ch < numChannels; ++ch) {
-    m_filterMixBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+  // At Eco the last rebuild can fall short of the blend's end, so the next
+  // constant block starts over from the settled warping.
+  if (isRewarping) {
+    m_warpingBlendRemaining = juce::jmax(0, m_warpingBlendRemaining - static_cast<int>(block.getNumSamples()));
+    m_coefficientsValid = false;
   }
 
-  m_filter.process(context);
+  m_isRunning = true;
+}
 
-  for (int ch = 0; ch < numChannels; ++ch) {
-    auto* wet = buffer.getWritePointer(ch);
-    const auto* dry = m_filterMixBuffer.getReadPointer(ch);
+template <typename SampleType>
+template <int ResponseType>
+void Filter<SampleType>::processResponse(juce::dsp::AudioBlock<SampleType>& block,
+                                         const PairParameters& params, bool steep, bool midSide)
+{
+  const auto numChannels = static_cast<int>(block.getNumChannels());
+  const auto numSamples = static_cast<int>(block.getNumSamples());
+
+  for (int ch = 0; ch < numChannels; ch += 2) {
+    auto* left = block.getChannelPointer(static_cast<size_t>(ch));
+    auto* right = ch + 1 < numChannels ? block.getChannelPointer(static_cast<size_t>(ch + 1)) : nullptr;
+    auto& state = m_states[static_cast<size_t>(ch / 2)];
 
-    for (int s = 0; s < numSamples; ++s) {
-      wet[s] = wet[s] * mix + dry[s] * (1.f - mix);
+    // Only the first pair is encoded; a mono leftover stays left/right.
+    if (midSide && ch == 0) {
+      if (steep)
+        processPair<ResponseType, true, true>(left, right, state, numSamples, params);
+      else
+        processPair<ResponseType, false, true>(left, right, state, numSamples, params);
+    } else {
+      if (steep)
+        processPair<ResponseType, true, false>(left, right, state, numSamples, params);
+      else
+        processPair<ResponseType, false, false>(left, right, state, numSamples, params);
     }
   }
 }
+
+template <typename SampleType>
+template <int ResponseType, bool Steep, bool MidSide>
+void Filter<SampleType>::processPair(SampleType* left, SampleType* right, PairState& state,
+                                     int numSamples, const PairParameters& params)
+{
+  const auto isModulated = ! params.cutoff.isConstant() || ! params.sideCutoff.isConstant()
+                           || ! params.q.isConstant() || m_warpingBlendRemaining > 0;
+  const auto one = SIMDType::expand(1);
+  auto input = SIMDType::expand(0);
+
+  for (int s = 0, untilUpdate = 0; s < numSamples; ++s) {
+    if (isModulated && --untilUpdate <= 0) {
+      updateCoefficients(params.cutoff[s], params.sideCutoff[s], params.q[s], getExactShare(s + 1));
+      untilUpdate = m_coefficientInterval;
+    }
+
+    if constexpr (MidSide) {
+      input.set(0, (left[s] + right[s]) * SampleType(0.5));
+      input.set(1, (left[s] - right[s]) * SampleType(0.5));
+    } else {
+      input.set(0, left[s]);
+      if (right != nullptr)
+        input.set(1, right[s]);
+    }
+
+    auto wet = tick<ResponseType>(input, m_stage1, state[0]);
+
+    if constexpr (Steep)
+      wet = tick<ResponseType>(wet, m_stage2, state[1]);
+
+    auto wetGain = SIMDType::expand(static_cast<SampleType>(params.mix[s]));
+
+    if constexpr (MidSide)
+      wetGain.set(1, static_cast<SampleType>(params.sideMix[s]));
+
+    const auto output = wet * wetGain + input * (one - wetGain);
+
+    if constexpr (MidSide) {
+      left[s] = output.get(0) + output.get(1);
+      right[s] = output.get(0) - output.get(1);
+    } else {
+      left[s] = output.get(0);
+      if (right != nullptr)
+        right[s] = output.get(1);
+    }
+  }
+}
+
+template class Filter<float>;
+template class Filter<double>;
@@ -1,22 +1,134 @@
 #pragma once
 #include <JuceHeader.h>
+#include "ParameterRamp.h"
+#include "Quality.h"
+#include "StereoParameters.h"
 
+// Topology-preserving-transform state-variable filter. Both channels of a
+// pair share one SIMD register, and a cutoff or Q change only recomputes a
+// handful of coefficients, so the filter can be swept per sample without
+// touching the heap. In the mid/side modes the pair is encoded into the
+// same register instead, with the side cutoff in the second lane.
+// Instantiated for float and double; double keeps the integrator states
+// clean at low cutoffs and high Q.
+template <typename SampleType>
 class Filter
 {
 public:
+  enum Response
+  {
+    highPass = 0,
+    lowPass,
+    bandPass,
+    notch
+  };
+
+  enum Slope
+  {
+    slope12dB = 0,
+    slope24dB
+  };
+
   void prepare(const juce::dsp::ProcessSpec& spec);
-  void process(juce::AudioBuffer<float>& buffer, float cutoff, float q, float mix);
+  void process(juce::dsp::AudioBlock<SampleType>& block, const ParameterRamp& cutoff,
+               const ParameterRamp& q, const ParameterRamp& mix, const StereoParameters& stereo,
+               int response, int slope, bool coefficientsChanged);
   void reset();
 
+  // Eco only follows a moving cutoff or Q every few samples; High warps the
+  // cutoff with std::tan instead of the Pade approximant. Once the filter is
+  // running, a change of warping blends over Quality::blendSeconds through
+  // the per-sample coefficient rebuild.
+  void setQuality(Quality::Level quality);
+
 private:
-  using MonoFilter = juce::dsp::IIR::Filter<float>;
-  using FilterCoeffs = juce::dsp::IIR::Coefficients<float>;
-  using StereoFilter = juce::dsp::ProcessorDuplicator<MonoFilter, FilterCoeffs>;
-  using FilterChain = juce::dsp::ProcessorChain<StereoFilter, StereoFilter>;
-
-  FilterChain m_filter;
-  juce::AudioBuffer<float> m_filterMixBuffer;
-  double m_sampleRate = 44100.0;
-  float m_lastFilterCutoff = -1.f;
-  float m_lastFilterQ = -1.f;
+  static constexpr int EcoCoefficientInterval = 8;
+
+  using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+
+  struct Coefficients
+  {
+    SIMDType a1, a2, a3, k;
+  };
+
+  struct StageState
+  {
+    SIMDType ic1eq, ic2eq;
+  };
+
+  // Two cascaded stages per channel pair; the second only runs at 24 dB/oct.
+  using PairState = std::array<StageState, 2>;
+
+  // Per-lane settings for one pair: mid and side in the mid/side modes,
+  // otherwise the same ramps for both channels.
+  struct PairParameters
+  {
+    ParameterRamp cutoff, sideCutoff, q, mix, sideMix;
+  };
+
+  template <int ResponseType>
+  void processResponse(juce::dsp::AudioBlock<SampleType>& block, const PairParameters& params,
+                       bool steep, bool midSide);
+
+  template <int ResponseType, bool Steep, bool MidSide>
+  void processPair(SampleType* left, SampleType* right, PairState& state, int numSamples,
+                   const PairParameters& params);
+
+  template <int ResponseType>
+  static SIMDType tick(SIMDType input, const Coefficients& coeffs, StageState& state)
+  {
+    const auto v3 = input - state.ic2eq;
+    const auto v1 = coeffs.a1 * state.ic1eq + coeffs.a2 * v3;
+    const auto v2 = state.ic2eq + coeffs.a2 * state.ic1eq + coeffs.a3 * v3;
+
+    state.ic1eq = v1 * SampleType(2) - state.ic1eq;
+    state.ic2eq = v2 * SampleType(2) - state.ic2eq;
+
+    if constexpr (ResponseType == lowPass)
+      return v2;
+    else if constexpr (ResponseType == bandPass)
+      return coeffs.k * v1;
+    else if constexpr (ResponseType == notch)
+      return input - coeffs.k * v1;
+    else
+      return input - coeffs.k * v1 - v2;
+  }
+
+  void updateCoefficients(SampleType cutoff, SampleType sideCutoff, SampleType q, SampleType exactShare);
+  SampleType getWarpedCutoff(SampleType cutoff, SampleType exactShare) const;
+  // How much of the warping comes from std::tan, numSamples into the block.
+  SampleType getExactShare(int numSamples) const;
+  static Coefficients makeCoefficients(SampleType g, SampleType sideG, SampleType k);
+
+  // Pade approximant of tan(x), which alone drifts to 0.03% off near the
+  // 0.49 * pi clamp. Above pi/4 it goes through tan(x) = 1 / tan(pi/2 - x)
+  // instead, staying within 2e-6 of std::tan (relative, 1.4e-8 in double).
+  static SampleType fastTan(SampleType x)
+  {
+    constexpr auto quarterPi = juce::MathConstants<SampleType>::pi / SampleType(4);
+
+    if (x > quarterPi)
+      return SampleType(1) / fastTanPade(juce::MathConstants<SampleType>::halfPi - x);
+
+    return fastTanPade(x);
+  }
+
+  static SampleType fastTanPade(SampleType x)
+  {
+    const auto x2 = x * x;
+    return x * (SampleType(945) + x2 * (x2 - SampleType(105)))
+           / (SampleType(945) + x2 * (SampleType(15) * x2 - SampleType(420)));
+  }
+
+  Coefficients m_stage1;
+  Coefficients m_stage2;
+  std::vector<PairState> m_states;
+  SampleType m_piOverSampleRate = juce::MathConstants<SampleType>::pi / SampleType(44100);
+  SampleType m_maxCutoff = SampleType(0.49 * 44100.0);
+  bool m_coefficientsValid = false;
+  int m_coefficientInterval = 1;
+  bool m_exactWarping = false;
+  int m_warpingBlendLength = 0;
+  int m_warpingBlendRemaining = 0;
+  bool m_isRunning = false;
 };
@@ -0,0 +1,56 @@
+#pragma once
+#include <JuceHeader.h>
+#include "DspLoadMonitor.h"
+
+class LoadMeter : public juce::Component, private juce::Timer
+{
+public:
+  LoadMeter(DspLoadMonitor& monitor) : m_monitor(monitor)
+  {
+    startTimerHz(30);
+  }
+
+  void paint(juce::Graphics& g) override
+  {
+    auto bounds = getLocalBounds().toFloat();
+
+    g.fillAll(juce::Colour(0xff1a1a2e));
+
+    g.setColour(juce::Colours::white.withAlpha(0.1f));
+    g.drawRect(bounds, 1.f);
+
+    auto text = bounds.removeFromBottom(16.f);
+    auto meter = bounds.reduced(8.f, 6.f);
+
+    const auto level = juce::jlimit(0.f, 1.f, m_displayLoad);
+    const auto meterColour = m_displayLoad >= 0.9f ? juce::Colour(0xffff4d6d) : juce::Colour(0xff00e5ff);
+
+    g.setColour(meterColour.withAlpha(0.8f));
+    g.fillRect(meter.withTop(meter.getBottom() - meter.getHeight() * level));
+
+    const auto peakY = meter.getBottom() - meter.getHeight() * juce::jlimit(0.f, 1.f, m_displayPeak);
+    g.setColour(juce::Colours::white.withAlpha(0.7f));
+    g.drawHorizontalLine(static_cast<int>(peakY), meter.getX(), meter.getRight());
+
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.setFont(juce::FontOptions(10.f, juce::Font::bold));
+    g.drawFittedText("DSP " + juce::String(juce::roundToInt(m_displayLoad * 100.f)) + "%",
+                     text.toNearestInt(), juce::Justification::centred, 1);
+  }
+
+private:
+  void timerCallback() override
+  {
+    // Fast attack, slow release so short spikes stay visible.
+    const auto load = m_monitor.getLoad();
+    m_displayLoad = load > m_displayLoad ? load : m_displayLoad * 0.9f + load * 0.1f;
+    m_displayPeak = juce::jmax(m_monitor.takePeakLoad(), m_displayPeak * 0.98f);
+    repaint();
+  }
+
+  DspLoadMonitor& m_monitor;
+  float m_displayLoad = 0.f;
+  float m_displayPeak = 0.f;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoadMeter)
+};
@@ -0,0 +1,101 @@
+#include "MidiLearn.h"
+
+const char* MidiLearn::getParameterID(Target target)
+{
+  switch (target) {
+    case drive:  return "Drive";
+    case mix:    return "Mix";
+    case cutoff: return "Filter Cutoff";
+    case q:      return "Filter Q";
+    case type:   return "Type";
+    default:     return nullptr;
+  }
+}
+
+juce::String MidiLearn::getName(Target target)
+{
+  switch (target) {
+    case drive:  return "Drive";
+    case mix:    return "Mix";
+    case cutoff: return "Cutoff";
+    case q:      return "Q";
+    case type:   return "Type";
+    default:     return "None";
+  }
+}
+
+void MidiLearn::assign(int controller, Target target)
+{
+  jassert(juce::isPositiveAndBelow(controller, NumControllers));
+
+  // A target follows one controller; learning it again moves it.
+  if (target != none) {
+    for (auto& entry : m_targets) {
+      if (entry.load(std::memory_order_relaxed) == target)
+        entry.store(none, std::memory_order_relaxed);
+    }
+  }
+
+  m_targets[static_cast<size_t>(controller)].store(static_cast<juce::uint8>(target),
+                                                   std::memory_order_relaxed);
+}
+
+void MidiLearn::clearAll()
+{
+  m_learning.store(none);
+
+  for (auto& entry : m_targets)
+    entry.store(none, std::memory_order_relaxed);
+}
+
+MidiLearn::Target MidiLearn::getTarget(int controller) const
+{
+  return static_cast<Target>(m_targets[static_cast<size_t>(controller)].load(std::memory_order_relaxed));
+}
+
+bool MidiLearn::isMapped(const juce::MidiMessage& message) const
+{
+  return message.isController()
+         && (getLearnTarget() != none || getTarget(message.getControllerNumber()) != none);
+}
+
+MidiLearn::Target MidiLearn::resolve(int controller)
+{
+  auto learning = m_learning.load();
+
+  // Only the first controller completes the learn, even if the editor
+  // re-arms it meanwhile.
+  if (learning != none && m_learning.compare_exchange_strong(learning, none))
+    assign(controller, static_cast<Target>(learning));
+
+  return getTarget(controller);
+}
+
+void MidiLearn::write(juce::MemoryBlock& dest) const
+{
+  const auto magic = juce::ByteOrder::swapIfBigEndian(Magic);
+  dest.append(&magic, sizeof(magic));
+
+  std::array<juce::uint8, NumControllers> targets;
+
+  for (size_t i = 0; i < targets.size(); ++i)
+    targets[i] = m_targets[i].load(std::memory_order_relaxed);
+
+  dest.append(targets.data(), targets.size());
+}
+
+void MidiLearn::read(const void* data, size_t sizeInBytes)
+{
+  const auto* bytes = static_cast<const juce::uint8*>(data);
+
+  if (data == nullptr || sizeInBytes < sizeof(Magic) + NumControllers
+      || juce::ByteOrder::littleEndianInt(bytes) != Magic) {
+    clearAll();
+    return;
+  }
+
+  for (size_t i = 0; i < NumControllers; ++i) {
+    const auto target = bytes[sizeof(Magic) + i];
+    m_targets[i].store(target < NumTargets ? target : juce::uint8(none), std::memory_order_relaxed);
+  }
+}
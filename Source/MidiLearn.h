@@ -0,0 +1,51 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Which parameter, if any, each MIDI CC number drives. The editor assigns
+// and clears mappings or arms a learn; the audio thread resolves incoming
+// controllers and completes a pending learn with the first CC it sees.
+// Every entry is its own atomic, so neither side ever waits on the other.
+class MidiLearn
+{
+public:
+  enum Target
+  {
+    none = 0,
+    drive,
+    mix,
+    cutoff,
+    q,
+    type,
+    NumTargets
+  };
+
+  static constexpr int NumControllers = 128;
+
+  static const char* getParameterID(Target target);
+  static juce::String getName(Target target);
+
+  // Message thread.
+  void assign(int controller, Target target);
+  void clearAll();
+  void learn(Target target) { m_learning.store(target); }
+  Target getLearnTarget() const { return static_cast<Target>(m_learning.load()); }
+  Target getTarget(int controller) const;
+
+  // Audio thread. Whether a message has to land on its exact sample, and
+  // the target it drives; resolve() binds the controller if a learn is armed.
+  bool isMapped(const juce::MidiMessage& message) const;
+  Target resolve(int controller);
+
+  // Appended to the plugin state after the parameters:
+  //   uint32 magic, NumControllers x uint8 target
+  static constexpr size_t StateSize = sizeof(juce::uint32) + NumControllers;
+  void write(juce::MemoryBlock& dest) const;
+  // Clears every mapping if data does not start with one.
+  void read(const void* data, size_t sizeInBytes);
+
+private:
+  static constexpr juce::uint32 Magic = 0x4d4b5853; // "SXKM"
+
+  std::array<std::atomic<juce::uint8>, NumControllers> m_targets{};
+  std::atomic<int> m_learning{ none };
+};
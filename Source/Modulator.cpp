@@ -0,0 +1,239 @@
+#include "Modulator.h"
+
+void Modulator::prepare(double sampleRate, int maximumBlockSize)
+{
+  m_sampleRate = sampleRate;
+  m_gainBuffer.setSize(NumDestinations, maximumBlockSize);
+
+  // Makes setSettings() work the follower's coefficients out for the new rate.
+  m_attackCoefficient = 0.f;
+  m_releaseCoefficient = 0.f;
+  setSettings(m_settings);
+  reset();
+}
+
+void Modulator::reset()
+{
+  m_lfoPhases.fill(0.0);
+  m_peak = 0.f;
+  m_envelope = 0.f;
+  m_sidechainSum = 0.f;
+  m_sidechainCount = 0;
+  m_sidechainEnvelope = 0.f;
+  m_samplesUntilTick = 0;
+  m_gains.fill(1.f);
+  m_targets.fill(1.f);
+  m_increments.fill(0.f);
+  m_active.fill(false);
+}
+
+void Modulator::setSettings(const Settings& settings)
+{
+  // The follower steps once per tick, so its time constants are in ticks.
+  const auto tickRate = m_sampleRate / ControlInterval;
+  const auto coefficient = [tickRate](float milliseconds) {
+    return static_cast<float>(std::exp(-1.0 / (0.001 * milliseconds * tickRate)));
+  };
+
+  if (settings.attackMs != m_settings.attackMs || m_attackCoefficient == 0.f)
+    m_attackCoefficient = coefficient(settings.attackMs);
+  if (settings.releaseMs != m_settings.releaseMs || m_releaseCoefficient == 0.f)
+    m_releaseCoefficient = coefficient(settings.releaseMs);
+
+  m_settings = settings;
+}
+
+void Modulator::setPosition(juce::int64 samplePosition)
+{
+  auto offset = static_cast<int>(samplePosition % ControlInterval);
+  if (offset < 0)
+    offset += ControlInterval;
+
+  m_samplesUntilTick = (ControlInterval - offset) % ControlInterval;
+  const auto nextTick = static_cast<double>(samplePosition + m_samplesUntilTick);
+
+  for (int i = 0; i < NumLfos; ++i) {
+    auto& phase = m_lfoPhases[static_cast<size_t>(i)];
+    phase = m_settings.lfos[static_cast<size_t>(i)].rate * nextTick / m_sampleRate;
+    phase -= std::floor(phase);
+  }
+}
+
+template <bool Rms, typename SampleType>
+float Modulator::measureLevel(const SampleType* data, int numSamples)
+{
+  using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+  constexpr auto step = static_cast<int>(SIMDType::SIMDNumElements);
+
+  const auto accumulate = [](auto level, auto x) {
+    if constexpr (Rms)
+      return level + x * x;
+    else
+      return simdMax(level, simdAbs(x));
+  };
+
+  auto level = SampleType(0);
+  auto levels = SIMDType::expand(0);
+  int i = 0;
+
+  for (; i < numSamples && ! SIMDType::isSIMDAligned(data + i); ++i)
+    level = accumulate(level, data[i]);
+
+  for (; i + step <= numSamples; i += step)
+    levels = accumulate(levels, SIMDType::fromRawArray(data + i));
+
+  for (; i < numSamples; ++i)
+    level = accumulate(level, data[i]);
+
+  for (size_t lane = 0; lane < SIMDType::SIMDNumElements; ++lane) {
+    if constexpr (Rms)
+      level += levels.get(lane);
+    else
+      level = juce::jmax(level, levels.get(lane));
+  }
+
+  return static_cast<float>(level);
+}
+
+template <typename SampleType>
+void Modulator::process(const juce::AudioBuffer<SampleType>& input,
+                        const juce::AudioBuffer<SampleType>& sidechain)
+{
+  const auto numSamples = input.getNumSamples();
+  const auto numChannels = input.getNumChannels();
+  const auto followInput = m_settings.envelopeDepth != 0.f;
+
+  // Without a routed sidechain its follower is skipped altogether.
+  m_sidechainConnected = sidechain.getNumChannels() > 0
+                         && (m_settings.sidechainDriveDepth != 0.f || m_settings.sidechainCutoffDepth != 0.f);
+
+  for (size_t d = 0; d < NumDestinations; ++d)
+    m_active[d] = isRouted(static_cast<int>(d)) || m_gains[d] != 1.f || m_targets[d] != 1.f;
+
+  for (int start = 0; start < numSamples;) {
+    if (m_samplesUntilTick == 0) {
+      tick();
+      m_samplesUntilTick = ControlInterval;
+    }
+
+    const auto length = juce::jmin(m_samplesUntilTick, numSamples - start);
+
+    if (followInput) {
+      for (int ch = 0; ch < numChannels; ++ch)
+        m_peak = juce::jmax(m_peak, measureLevel<false>(input.getReadPointer(ch, start), length));
+    }
+
+    if (m_sidechainConnected) {
+      // A mono sidechain is one channel; stereo folds the two together.
+      for (int ch = 0; ch < sidechain.getNumChannels(); ++ch) {
+        const auto* data = sidechain.getReadPointer(ch, start);
+
+        if (m_settings.sidechainRms)
+          m_sidechainSum += measureLevel<true>(data, length);
+        else
+          m_sidechainSum = juce::jmax(m_sidechainSum, measureLevel<false>(data, length));
+      }
+
+      m_sidechainCount += length * sidechain.getNumChannels();
+    }
+
+    for (size_t d = 0; d < NumDestinations; ++d) {
+      if (! m_active[d])
+        continue;
+
+      auto* gains = m_gainBuffer.getWritePointer(static_cast<int>(d), start);
+      auto gain = m_gains[d];
+
+      for (int i = 0; i < length; ++i) {
+        gain += m_increments[d];
+        gains[i] = gain;
+      }
+
+      m_gains[d] = gain;
+    }
+
+    start += length;
+    m_samplesUntilTick -= length;
+  }
+}
+
+void Modulator::tick()
+{
+  // Land exactly on the previous targets so unity is reached again once the
+  // modulation stops.
+  m_gains = m_targets;
+
+  const auto coefficient = m_peak > m_envelope ? m_attackCoefficient : m_releaseCoefficient;
+  m_envelope = m_peak + coefficient * (m_envelope - m_peak);
+  m_peak = 0.f;
+
+  if (m_sidechainConnected) {
+    const auto level = m_settings.sidechainRms && m_sidechainCount > 0
+                         ? std::sqrt(m_sidechainSum / static_cast<float>(m_sidechainCount))
+                         : m_sidechainSum;
+    const auto sidechainCoefficient = level > m_sidechainEnvelope ? m_attackCoefficient : m_releaseCoefficient;
+    m_sidechainEnvelope = level + sidechainCoefficient * (m_sidechainEnvelope - level);
+  } else {
+    m_sidechainEnvelope = 0.f;
+  }
+
+  m_sidechainSum = 0.f;
+  m_sidechainCount = 0;
+
+  std::array<float, NumDestinations> octaves{};
+
+  for (int i = 0; i < NumLfos; ++i) {
+    const auto& lfo = m_settings.lfos[static_cast<size_t>(i)];
+    auto& phase = m_lfoPhases[static_cast<size_t>(i)];
+
+    if (lfo.depth != 0.f)
+      octaves[static_cast<size_t>(lfo.destination)] += lfo.depth * getLfoValue(i);
+
+    phase += lfo.rate * ControlInterval / m_sampleRate;
+    phase -= std::floor(phase);
+  }
+
+  if (m_settings.envelopeDepth != 0.f)
+    octaves[static_cast<size_t>(m_settings.envelopeDestination)]
+      += m_settings.envelopeDepth * juce::jmin(m_envelope, 1.f);
+
+  if (m_sidechainConnected) {
+    const auto level = juce::jmin(m_sidechainEnvelope, 1.f);
+    octaves[drive] += m_settings.sidechainDriveDepth * level;
+    octaves[cutoff] += m_settings.sidechainCutoffDepth * level;
+  }
+
+  for (size_t d = 0; d < NumDestinations; ++d) {
+    m_targets[d] = std::exp2(octaves[d] * OctaveRange[d]);
+    m_increments[d] = (m_targets[d] - m_gains[d]) / static_cast<float>(ControlInterval);
+  }
+}
+
+float Modulator::getLfoValue(int index) const
+{
+  const auto phase = static_cast<float>(m_lfoPhases[static_cast<size_t>(index)]);
+
+  switch (m_settings.lfos[static_cast<size_t>(index)].shape) {
+    case triangle: return 1.f - 4.f * std::abs(phase - 0.5f);
+    case saw:      return 2.f * phase - 1.f;
+    case square:   return phase < 0.5f ? 1.f : -1.f;
+    default:       return std::sin(juce::MathConstants<float>::twoPi * phase);
+  }
+}
+
+bool Modulator::isRouted(int destination) const
+{
+  for (const auto& lfo : m_settings.lfos)
+    if (lfo.depth != 0.f && lfo.destination == destination)
+      return true;
+
+  if (m_sidechainConnected
+      && ((destination == drive && m_settings.sidechainDriveDepth != 0.f)
+          || (destination == cutoff && m_settings.sidechainCutoffDepth != 0.f)))
+    return true;
+
+  return m_settings.envelopeDepth != 0.f && m_settings.envelopeDestination == destination;
+}
+
+template void Modulator::process<float>(const juce::AudioBuffer<float>&, const juce::AudioBuffer<float>&);
+template void Modulator::process<double>(const juce::AudioBuffer<double>&, const juce::AudioBuffer<double>&);
@@ -0,0 +1,104 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SIMDHelpers.h"
+
+// LFOs and an input envelope follower that move Filter Cutoff, Filter Q and
+// Drive, plus a sidechain follower that ducks or pushes Drive and Cutoff.
+// The sources only run once every ControlInterval samples; between
+// updates the gain on each destination is interpolated linearly, so the
+// stages get a smooth per-sample ramp for the cost of a control-rate tick.
+class Modulator
+{
+public:
+  static constexpr int NumLfos = 2;
+  static constexpr int ControlInterval = 32;
+
+  enum Destination
+  {
+    cutoff = 0,
+    q,
+    drive,
+    NumDestinations
+  };
+
+  enum Shape
+  {
+    sine = 0,
+    triangle,
+    saw,
+    square
+  };
+
+  struct LfoSettings
+  {
+    float rate = 1.f;
+    int shape = sine;
+    int destination = cutoff;
+    float depth = 0.f;
+  };
+
+  struct Settings
+  {
+    std::array<LfoSettings, NumLfos> lfos;
+    float attackMs = 5.f;
+    float releaseMs = 100.f;
+    int envelopeDestination = cutoff;
+    float envelopeDepth = 0.f;
+    float sidechainDriveDepth = 0.f;
+    float sidechainCutoffDepth = 0.f;
+    bool sidechainRms = false;
+  };
+
+  void prepare(double sampleRate, int maximumBlockSize);
+  void reset();
+  void setSettings(const Settings& settings);
+
+  // Puts the LFOs and the control ticks where a run starting at sample 0
+  // would have them at samplePosition, assuming the current rates held.
+  void setPosition(juce::int64 samplePosition);
+
+  // Follows the block's input and renders the destination gains for it, so
+  // it has to run before the chain overwrites the buffer. A sidechain with no
+  // channels counts as disconnected and is never read.
+  template <typename SampleType>
+  void process(const juce::AudioBuffer<SampleType>& input,
+               const juce::AudioBuffer<SampleType>& sidechain);
+
+  // Inactive destinations are left at unity and have no gains rendered.
+  bool isActive(Destination destination) const { return m_active[static_cast<size_t>(destination)]; }
+  const float* getGains(Destination destination) const { return m_gainBuffer.getReadPointer(destination); }
+
+private:
+  void tick();
+  float getLfoValue(int index) const;
+  bool isRouted(int destination) const;
+
+  // Peak, or sum of squares with Rms, of one channel. Whole SIMD registers
+  // once the pointer is aligned, scalar at either end.
+  template <bool Rms, typename SampleType>
+  static float measureLevel(const SampleType* data, int numSamples);
+
+  // Octaves covered at full depth, per destination.
+  static constexpr std::array<float, NumDestinations> OctaveRange{ 4.f, 2.f, 2.f };
+
+  Settings m_settings;
+  double m_sampleRate = 44100.0;
+  std::array<double, NumLfos> m_lfoPhases{};
+
+  float m_peak = 0.f;
+  float m_envelope = 0.f;
+  float m_attackCoefficient = 0.f;
+  float m_releaseCoefficient = 0.f;
+
+  bool m_sidechainConnected = false;
+  float m_sidechainSum = 0.f;
+  int m_sidechainCount = 0;
+  float m_sidechainEnvelope = 0.f;
+
+  int m_samplesUntilTick = 0;
+  std::array<float, NumDestinations> m_gains{};
+  std::array<float, NumDestinations> m_targets{};
+  std::array<float, NumDestinations> m_increments{};
+  std::array<bool, NumDestinations> m_active{};
+  juce::AudioBuffer<float> m_gainBuffer;
+};
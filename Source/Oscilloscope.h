@@ -3,10 +3,9 @@
 class Oscilloscope : public juce::Component, private juce::Timer
 {
 public:
-  Oscilloscope(ScopeDataQueue<ScopeBlockSize, ScopeNumBlocks>& queue) : m_queue(queue)
+  Oscilloscope(ScopeQueue& queue) : m_queue(queue)
   {
-    m_displayBuffer.fill(0.f);
-    startTimerHz(60);
+    startTimerHz(ActiveFrameRate);
   }
 
   void paint(juce::Graphics& g) override
@@ -23,37 +22,106 @@ public:
                          bounds.getX(),
                          bounds.getRight());
 
-    if (!m_hasData)
-      return;
-
-    juce::Path waveform;
-    const auto numSamples = static_cast<int>(m_displayBuffer.size());
-    const float xScale = bounds.getWidth() / static_cast<float>(numSamples - 1);
-    const float yCentre = bounds.getCentreY();
-    const float yScale = bounds.getHeight() * 0.45f;
+    if (m_hasData && m_trace.isValid())
+      g.drawImageAt(m_trace, 0, 0);
+  }
 
-    waveform.startNewSubPath(bounds.getX(), yCentre - m_displayBuffer[0] * yScale);
+  void resized() override
+  {
+    if (getWidth() > 0 && getHeight() > 0)
+      m_trace = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    else
+      m_trace = {};
 
-    for (int i = 1; i < numSamples; ++i) {
-      waveform.lineTo(bounds.getX() + static_cast<float>(i) * xScale,
-                      yCentre - m_displayBuffer[static_cast<size_t>(i)] * yScale);
-    }
+    if (m_hasData)
+      renderTrace();
+  }
 
-    g.setColour(juce::Colour(0xff00e5ff));
-    g.strokePath(waveform, juce::PathStrokeType(1.5f, juce::PathStrokeType::curved));
+  void visibilityChanged() override
+  {
+    if (isShowing())
+      startTimerHz(ActiveFrameRate);
+    else
+      stopTimer();
   }
 
 private:
+  // Each new block shows DisplaySamples starting at the first rising zero
+  // crossing in the older half, so periodic signals hold still.
+  static constexpr size_t DisplaySamples = ScopeBlockSize / 2;
+  static constexpr int ActiveFrameRate = 60;
+  static constexpr int IdleFrameRate = 10;
+  static constexpr int TicksBeforeIdle = 30;
+
   void timerCallback() override
   {
-    if (m_queue.pull(m_displayBuffer)) {
-      m_hasData = true;
-      repaint();
+    const auto* block = m_queue.readLatest();
+
+    if (block == nullptr) {
+      if (++m_idleTicks == TicksBeforeIdle)
+        startTimerHz(IdleFrameRate);
+
+      return;
+    }
+
+    if (m_idleTicks >= TicksBeforeIdle)
+      startTimerHz(ActiveFrameRate);
+
+    m_idleTicks = 0;
+
+    const auto& samples = block->channels[0];
+    const auto trigger = findTrigger(samples);
+    std::copy_n(samples.begin() + static_cast<std::ptrdiff_t>(trigger), DisplaySamples,
+                m_displayBuffer.begin());
+
+    m_hasData = true;
+    renderTrace();
+    repaint();
+  }
+
+  static size_t findTrigger(const std::array<float, ScopeBlockSize>& samples)
+  {
+    for (size_t i = 1; i <= ScopeBlockSize - DisplaySamples; ++i)
+      if (samples[i - 1] < 0.f && samples[i] >= 0.f)
+        return i;
+
+    return 0;
+  }
+
+  // Draws one vertical min/max span per pixel column. Each column also takes
+  // the last sample of the previous one so neighbouring spans always join.
+  void renderTrace()
+  {
+    if (! m_trace.isValid())
+      return;
+
+    m_trace.clear(m_trace.getBounds());
+
+    juce::Graphics g(m_trace);
+    g.setColour(juce::Colour(0xff00e5ff));
+
+    const auto width = m_trace.getWidth();
+    const auto yCentre = static_cast<float>(m_trace.getHeight()) * 0.5f;
+    const auto yScale = static_cast<float>(m_trace.getHeight()) * 0.45f;
+    const auto samplesPerColumn = static_cast<double>(DisplaySamples) / width;
+
+    for (int x = 0; x < width; ++x) {
+      const auto first = static_cast<size_t>(x * samplesPerColumn);
+      const auto last = juce::jmax(first + 1, static_cast<size_t>((x + 1) * samplesPerColumn));
+      const auto begin = m_displayBuffer.begin() + static_cast<std::ptrdiff_t>(first > 0 ? first - 1 : 0);
+      const auto end = m_displayBuffer.begin() + static_cast<std::ptrdiff_t>(juce::jmin(last, DisplaySamples));
+      const auto [low, high] = std::minmax_element(begin, end);
+
+      const auto top = yCentre - *high * yScale;
+      const auto bottom = yCentre - *low * yScale;
+      g.fillRect(static_cast<float>(x), top, 1.f, juce::jmax(1.f, bottom - top));
     }
   }
 
-  ScopeDataQueue<ScopeBlockSize, ScopeNumBlocks>& m_queue;
-  std::array<float, ScopeBlockSize> m_displayBuffer;
+  ScopeQueue& m_queue;
+  std::array<float, DisplaySamples> m_displayBuffer{};
+  juce::Image m_trace;
+  int m_idleTicks = 0;
   bool m_hasData = false;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Oscilloscope)
@@ -0,0 +1,50 @@
+#pragma once
+#include <JuceHeader.h>
+
+// A block's worth of one parameter: either a single constant value, or a
+// per-sample ramp rendered from a juce::SmoothedValue while it is moving.
+// Stages check isConstant() to keep their fixed-parameter fast paths.
+struct ParameterRamp
+{
+  float value = 0.f;
+  const float* values = nullptr;
+  int shift = 0;
+
+  bool isConstant() const { return values == nullptr; }
+
+  float operator[](int index) const
+  {
+    return values != nullptr ? values[index >> shift] : value;
+  }
+
+  // Indexes the same ramp from a block running at 2^factorLog2 times the rate.
+  ParameterRamp withOversampling(int factorLog2) const
+  {
+    auto ramp = *this;
+    ramp.shift += factorLog2;
+    return ramp;
+  }
+
+  template <typename Smoother>
+  static ParameterRamp fromSmoother(Smoother& smoother, float* storage, int numSamples)
+  {
+    if (! smoother.isSmoothing())
+      return { smoother.getTargetValue() };
+
+    for (int i = 0; i < numSamples; ++i)
+      storage[i] = smoother.getNextValue();
+
+    return { storage[numSamples - 1], storage };
+  }
+
+  // ramp scaled by per-sample gains and kept within [minimum, maximum].
+  // storage may be the one ramp itself was rendered into.
+  static ParameterRamp modulated(const ParameterRamp& ramp, const float* gains, float* storage,
+                                 int numSamples, float minimum, float maximum)
+  {
+    for (int i = 0; i < numSamples; ++i)
+      storage[i] = juce::jlimit(minimum, maximum, ramp[i] * gains[i]);
+
+    return { storage[numSamples - 1], storage };
+  }
+};
@@ -0,0 +1,114 @@
+#include "ParameterSnapshot.h"
+
+ParameterSnapshot::ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts)
+{
+  for (size_t i = 0; i < NumParameters; ++i) {
+    auto* parameter = apvts.getParameter(getParameterID(static_cast<Index>(i)));
+    jassert(parameter != nullptr);
+
+    m_parameters[i] = parameter;
+    m_shared[i].store(parameter->convertFrom0to1(parameter->getValue()), std::memory_order_relaxed);
+    parameter->addListener(this);
+  }
+}
+
+ParameterSnapshot::~ParameterSnapshot()
+{
+  for (auto* parameter : m_parameters)
+    parameter->removeListener(this);
+}
+
+ParameterSnapshot::Mask ParameterSnapshot::update()
+{
+  const auto dirty = m_dirty.exchange(0, std::memory_order_acquire);
+
+  for (size_t i = 0; i < NumParameters; ++i)
+    if ((dirty & (Mask(1) << i)) != 0)
+      m_values[i] = m_shared[i].load(std::memory_order_relaxed);
+
+  return dirty;
+}
+
+void ParameterSnapshot::set(Index index, float value)
+{
+  m_shared[static_cast<size_t>(index)].store(value, std::memory_order_relaxed);
+  m_dirty.fetch_or(bit(index), std::memory_order_release);
+}
+
+ParameterSnapshot::Index ParameterSnapshot::find(const juce::String& parameterID)
+{
+  for (int i = 0; i < NumParameters; ++i)
+    if (parameterID == getParameterID(static_cast<Index>(i)))
+      return static_cast<Index>(i);
+
+  return NumParameters;
+}
+
+void ParameterSnapshot::parameterValueChanged(int parameterIndex, float newValue)
+{
+  for (size_t i = 0; i < NumParameters; ++i) {
+    if (m_parameters[i]->getParameterIndex() == parameterIndex) {
+      m_shared[i].store(m_parameters[i]->convertFrom0to1(newValue), std::memory_order_relaxed);
+      m_dirty.fetch_or(Mask(1) << i, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+const char* ParameterSnapshot::getParameterID(Index index)
+{
+  switch (index) {
+    case drive:              return "Drive";
+    case mix:                return "Mix";
+    case clipType:           return "Type";
+    case oversampling:       return "Oversampling";
+    case oversamplingFilter: return "Oversampling Filter";
+    case filterCutoff:       return "Filter Cutoff";
+    case filterRouting:      return "Filter Routing";
+    case filterQ:            return "Filter Q";
+    case filterType:         return "Filter Type";
+    case filterSlope:        return "Filter Slope";
+    case multiband:          return "Multiband";
+    case crossover1:         return "Crossover 1";
+    case crossover2:         return "Crossover 2";
+    case crossover3:         return "Crossover 3";
+    case band1Drive:         return "Band 1 Drive";
+    case band1Mix:           return "Band 1 Mix";
+    case band1Type:          return "Band 1 Type";
+    case band2Drive:         return "Band 2 Drive";
+    case band2Mix:           return "Band 2 Mix";
+    case band2Type:          return "Band 2 Type";
+    case band3Drive:         return "Band 3 Drive";
+    case band3Mix:           return "Band 3 Mix";
+    case band3Type:          return "Band 3 Type";
+    case band4Drive:         return "Band 4 Drive";
+    case band4Mix:           return "Band 4 Mix";
+    case band4Type:          return "Band 4 Type";
+    case lfo1Rate:           return "LFO 1 Rate";
+    case lfo1Shape:          return "LFO 1 Shape";
+    case lfo1Target:         return "LFO 1 Target";
+    case lfo1Depth:          return "LFO 1 Depth";
+    case lfo2Rate:           return "LFO 2 Rate";
+    case lfo2Shape:          return "LFO 2 Shape";
+    case lfo2Target:         return "LFO 2 Target";
+    case lfo2Depth:          return "LFO 2 Depth";
+    case envelopeAttack:     return "Envelope Attack";
+    case envelopeRelease:    return "Envelope Release";
+    case envelopeTarget:     return "Envelope Target";
+    case envelopeDepth:      return "Envelope Depth";
+    case sidechainDrive:     return "Sidechain Drive";
+    case sidechainCutoff:    return "Sidechain Cutoff";
+    case sidechainDetector:  return "Sidechain Detector";
+    case stereoMode:         return "Stereo Mode";
+    case sideValues:         return "Side Values";
+    case sideDrive:          return "Side Drive";
+    case sideMix:            return "Side Mix";
+    case sideCutoff:         return "Side Cutoff";
+    case quality:            return "Quality";
+    case cabinet:            return "Cabinet";
+    case NumParameters:      break;
+  }
+
+  jassertfalse;
+  return "";
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <JuceHeader.h>
+
+// The current value of every parameter processBlock reads, packed into a
+// few cache lines. Parameter listeners store new values from whichever
+// thread changed them and flag them in a dirty mask; once per block the
+// audio thread takes the mask, copies just the flagged values and hands the
+// bits on so each stage only rebuilds what depends on them.
+class ParameterSnapshot : private juce::AudioProcessorParameter::Listener
+{
+public:
+  enum Index
+  {
+    drive = 0,
+    mix,
+    clipType,
+    oversampling,
+    oversamplingFilter,
+    filterCutoff,
+    filterRouting,
+    filterQ,
+    filterType,
+    filterSlope,
+    multiband,
+    crossover1,
+    crossover2,
+    crossover3,
+    band1Drive,
+    band1Mix,
+    band1Type,
+    band2Drive,
+    band2Mix,
+    band2Type,
+    band3Drive,
+    band3Mix,
+    band3Type,
+    band4Drive,
+    band4Mix,
+    band4Type,
+    lfo1Rate,
+    lfo1Shape,
+    lfo1Target,
+    lfo1Depth,
+    lfo2Rate,
+    lfo2Shape,
+    lfo2Target,
+    lfo2Depth,
+    envelopeAttack,
+    envelopeRelease,
+    envelopeTarget,
+    envelopeDepth,
+    sidechainDrive,
+    sidechainCutoff,
+    sidechainDetector,
+    stereoMode,
+    sideValues,
+    sideDrive,
+    sideMix,
+    sideCutoff,
+    quality,
+    cabinet,
+    NumParameters
+  };
+
+  using Mask = juce::uint64;
+
+  static_assert(NumParameters <= 64, "Mask has one bit per parameter");
+
+  static constexpr Mask bit(Index index) { return Mask(1) << index; }
+
+  // The same setting of another band, e.g. band(band1Drive, 2) is band3Drive.
+  static constexpr Index band(Index firstBand, int bandIndex)
+  {
+    return static_cast<Index>(firstBand + bandIndex * (band2Drive - band1Drive));
+  }
+
+  // Likewise for the LFOs, e.g. lfo(lfo1Depth, 1) is lfo2Depth.
+  static constexpr Index lfo(Index firstLfo, int lfoIndex)
+  {
+    return static_cast<Index>(firstLfo + lfoIndex * (lfo2Rate - lfo1Rate));
+  }
+
+  explicit ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts);
+  ~ParameterSnapshot() override;
+
+  // Audio thread. Returns the bits of the parameters that changed since the
+  // previous call; everything is flagged on the first one.
+  Mask update();
+
+  float get(Index index) const { return m_values[static_cast<size_t>(index)]; }
+  int getIndex(Index index) const { return juce::roundToInt(get(index)); }
+
+  // Audio thread. Stores a value the next update() picks up, ahead of the
+  // parameter itself, which whoever calls this has to bring in line later.
+  void set(Index index, float value);
+
+  // The entry for a parameter ID, or NumParameters if it has none.
+  static Index find(const juce::String& parameterID);
+
+private:
+  void parameterValueChanged(int parameterIndex, float newValue) override;
+  void parameterGestureChanged(int, bool) override {}
+
+  static const char* getParameterID(Index index);
+
+  // Written by the listeners, read by update().
+  alignas(64) std::array<std::atomic<float>, NumParameters> m_shared;
+  std::atomic<Mask> m_dirty{ ~Mask(0) };
+
+  // Audio thread only.
+  alignas(64) std::array<float, NumParameters> m_values{};
+
+  std::array<juce::RangedAudioParameter*, NumParameters> m_parameters{};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSnapshot)
+};
@@ -0,0 +1,159 @@
+#include "ParameterState.h"
+
+namespace
+{
+  template <typename IntType>
+  void writeLittleEndian(char* dest, IntType value)
+  {
+    value = juce::ByteOrder::swapIfBigEndian(value);
+    std::memcpy(dest, &value, sizeof(value));
+  }
+}
+
+ParameterState::ParameterState(juce::AudioProcessorValueTreeState& apvts)
+{
+  for (auto* parameter : apvts.processor.getParameters()) {
+    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter)) {
+      const auto idHash = static_cast<juce::uint32>(ranged->getParameterID().hashCode());
+      jassert(std::none_of(m_entries.begin(), m_entries.end(),
+                           [idHash](const Entry& entry) { return entry.idHash == idHash; }));
+      m_entries.push_back({ idHash, ranged });
+    }
+  }
+}
+
+void ParameterState::write(juce::MemoryBlock& dest) const
+{
+  dest.reset();
+  append(capture(), dest);
+}
+
+void ParameterState::append(const std::vector<float>& values, juce::MemoryBlock& dest) const
+{
+  jassert(values.size() == m_entries.size());
+
+  const auto offset = dest.getSize();
+  dest.setSize(offset + HeaderSize + EntrySize * m_entries.size());
+  auto* bytes = static_cast<char*>(dest.getData()) + offset;
+
+  writeLittleEndian(bytes, Magic);
+  writeLittleEndian(bytes + 4, Version);
+  writeLittleEndian(bytes + 6, static_cast<juce::uint16>(m_entries.size()));
+
+  auto* entry = bytes + HeaderSize;
+
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    const auto& [idHash, parameter] = m_entries[i];
+    const auto value = parameter->convertFrom0to1(i < values.size() ? values[i] : parameter->getDefaultValue());
+    juce::uint32 valueBits;
+    std::memcpy(&valueBits, &value, sizeof(valueBits));
+
+    writeLittleEndian(entry, idHash);
+    writeLittleEndian(entry + 4, valueBits);
+    entry += EntrySize;
+  }
+}
+
+bool ParameterState::isBinaryState(const void* data, int sizeInBytes)
+{
+  return data != nullptr && sizeInBytes >= static_cast<int>(HeaderSize)
+         && juce::ByteOrder::littleEndianInt(data) == Magic;
+}
+
+size_t ParameterState::getSizeInBytes(const void* data)
+{
+  const auto count = juce::ByteOrder::littleEndianShort(static_cast<const char*>(data) + 6);
+  return HeaderSize + EntrySize * count;
+}
+
+bool ParameterState::read(const void* data, int sizeInBytes) const
+{
+  std::vector<float> values;
+
+  if (! decode(data, sizeInBytes, values))
+    return false;
+
+  apply(values);
+  return true;
+}
+
+bool ParameterState::decode(const void* data, int sizeInBytes, std::vector<float>& values) const
+{
+  if (! isBinaryState(data, sizeInBytes))
+    return false;
+
+  const auto* bytes = static_cast<const char*>(data);
+  const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+  const auto count = static_cast<size_t>(juce::ByteOrder::littleEndianShort(bytes + 6));
+
+  if (version > Version || HeaderSize + EntrySize * count > static_cast<size_t>(sizeInBytes))
+    return false;
+
+  values.resize(m_entries.size());
+
+  for (size_t i = 0; i < m_entries.size(); ++i)
+    values[i] = m_entries[i].parameter->getDefaultValue();
+
+  for (size_t i = 0; i < count; ++i) {
+    const auto* entry = bytes + HeaderSize + EntrySize * i;
+    const auto idHash = juce::ByteOrder::littleEndianInt(entry);
+    const auto valueBits = juce::ByteOrder::littleEndianInt(entry + 4);
+
+    for (size_t p = 0; p < m_entries.size(); ++p) {
+      if (m_entries[p].idHash == idHash) {
+        float value;
+        std::memcpy(&value, &valueBits, sizeof(value));
+        values[p] = m_entries[p].parameter->convertTo0to1(value);
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+std::vector<float> ParameterState::capture() const
+{
+  std::vector<float> values;
+  values.reserve(m_entries.size());
+
+  for (const auto& entry : m_entries)
+    values.push_back(entry.parameter->getValue());
+
+  return values;
+}
+
+std::vector<float> ParameterState::make(std::initializer_list<std::pair<const char*, float>> values) const
+{
+  std::vector<float> result;
+  result.reserve(m_entries.size());
+
+  for (const auto& entry : m_entries)
+    result.push_back(entry.parameter->getDefaultValue());
+
+  for (const auto& [id, value] : values) {
+    const auto idHash = static_cast<juce::uint32>(juce::String(id).hashCode());
+    const auto match = std::find_if(m_entries.begin(), m_entries.end(),
+                                    [idHash](const Entry& entry) { return entry.idHash == idHash; });
+    jassert(match != m_entries.end());
+
+    if (match != m_entries.end())
+      result[static_cast<size_t>(match - m_entries.begin())] = match->parameter->convertTo0to1(value);
+  }
+
+  return result;
+}
+
+void ParameterState::apply(const std::vector<float>& values) const
+{
+  jassert(values.size() == m_entries.size());
+
+  for (size_t i = 0; i < juce::jmin(values.size(), m_entries.size()); ++i)
+    setValue(*m_entries[i].parameter, values[i]);
+}
+
+void ParameterState::setValue(juce::RangedAudioParameter& parameter, float normalisedValue)
+{
+  if (! juce::approximatelyEqual(parameter.getValue(), normalisedValue))
+    parameter.setValueNotifyingHost(normalisedValue);
+}
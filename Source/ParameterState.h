@@ -0,0 +1,54 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Compact binary snapshot of every APVTS parameter, used for plugin state
+// and presets instead of round-tripping the ValueTree through XML:
+//
+//   uint32 magic, uint16 version, uint16 count,
+//   count x { uint32 parameter ID hash, float32 value }   (little endian)
+//
+// Values are stored unnormalised so a state survives range changes, and
+// parameters are matched by ID so adding or reordering them is harmless.
+// Parameters missing from a state go back to their defaults.
+class ParameterState
+{
+public:
+  static constexpr juce::uint32 Magic = 0x53584b53; // "SKXS"
+  static constexpr juce::uint16 Version = 1;
+
+  explicit ParameterState(juce::AudioProcessorValueTreeState& apvts);
+
+  void write(juce::MemoryBlock& dest) const;
+  static bool isBinaryState(const void* data, int sizeInBytes);
+  // Returns false, changing nothing, if data is not a readable binary state.
+  bool read(const void* data, int sizeInBytes) const;
+  // Like read(), but only decodes into normalised values in parameter order.
+  bool decode(const void* data, int sizeInBytes, std::vector<float>& values) const;
+  // Bytes a readable state occupies; whatever follows belongs to the caller.
+  static size_t getSizeInBytes(const void* data);
+
+  // Normalised values in parameter order, for in-memory presets.
+  std::vector<float> capture() const;
+  void apply(const std::vector<float>& values) const;
+  // Appends a state holding captured values rather than the current ones.
+  void append(const std::vector<float>& values, juce::MemoryBlock& dest) const;
+  // Defaults, with the listed parameters at unnormalised values; for
+  // factory presets.
+  std::vector<float> make(std::initializer_list<std::pair<const char*, float>> values) const;
+
+private:
+  static constexpr size_t HeaderSize = 8;
+  static constexpr size_t EntrySize = 8;
+
+  struct Entry
+  {
+    juce::uint32 idHash;
+    juce::RangedAudioParameter* parameter;
+  };
+
+  static void setValue(juce::RangedAudioParameter& parameter, float normalisedValue);
+
+  std::vector<Entry> m_entries;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterState)
+};
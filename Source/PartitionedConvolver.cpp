@@ -0,0 +1,230 @@
+#include "PartitionedConvolver.h"
+
+namespace
+{
+  // Covers the furthest any segment reaches: two of the largest partitions
+  // of input behind the write position, and its partition plus offset of
+  // output ahead of it.
+  constexpr int RingSize = 4 * PartitionedConvolver::MaxPartitionSize;
+
+  // Segment n > 0 forwards on tick n - 1 of its partition and inverts on
+  // tick n before the end, which keeps the 256, 1024 and 4096 sample
+  // segments' six transforms on distinct ticks; a fourth segment would
+  // collide with the first.
+  static_assert(PartitionedConvolver::MaxPartitionSize <= 64 * PartitionedConvolver::TickSize,
+                "staggered transforms only separate three segments");
+}
+
+PartitionedConvolver::PartitionedConvolver(const float* impulse, int length, int numChannels)
+    : m_length(juce::jmax(0, length))
+{
+  m_channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+
+  if (m_length == 0)
+    return;
+
+  m_headLength = juce::jmin(m_length, HeadLength);
+  for (int i = 0; i < m_headLength; ++i)
+    m_reversedHead[static_cast<size_t>(HeadLength - 1 - i)] = impulse[i];
+
+  // Each segment may start once the next, four times larger, partition is
+  // due; the largest size repeats until the end of the response.
+  for (int offset = HeadLength, size = TickSize; offset < m_length;) {
+    const auto next = size < MaxPartitionSize ? 4 * size : size;
+    const auto end = size < MaxPartitionSize ? juce::jmin(m_length, 2 * next) : m_length;
+
+    Segment segment;
+    segment.partitionSize = size;
+    segment.offset = offset;
+    segment.lag = juce::jmax(0, static_cast<int>(m_segments.size()) - 1);
+    segment.numPartitions = (end - offset + size - 1) / size;
+    segment.fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * size)));
+
+    const auto numBins = segment.getNumBins();
+    std::vector<float> buffer(static_cast<size_t>(4 * size));
+    segment.impulseSpectra.resize(static_cast<size_t>(segment.numPartitions * numBins));
+
+    for (int k = 0; k < segment.numPartitions; ++k) {
+      std::fill(buffer.begin(), buffer.end(), 0.f);
+      const auto first = offset + k * size;
+      const auto count = juce::jmin(size, m_length - first);
+      std::copy(impulse + first, impulse + first + count, buffer.begin());
+
+      segment.fft->performRealOnlyForwardTransform(buffer.data(), true);
+      const auto* spectrum = reinterpret_cast<const Complex*>(buffer.data());
+      std::copy(spectrum, spectrum + numBins, segment.impulseSpectra.begin() + k * numBins);
+    }
+
+    segment.channels.resize(m_channels.size());
+    for (auto& channel : segment.channels) {
+      channel.inputSpectra.resize(static_cast<size_t>(segment.numPartitions * numBins));
+      channel.accumulator.resize(static_cast<size_t>(numBins));
+      channel.fftBuffer.resize(static_cast<size_t>(4 * size));
+    }
+
+    m_segments.push_back(std::move(segment));
+    offset = end;
+    size = next;
+  }
+
+  m_ringMask = RingSize - 1;
+  for (auto& channel : m_channels) {
+    channel.headHistory.resize(2 * HeadLength);
+    channel.input.resize(RingSize);
+    channel.output.resize(RingSize);
+  }
+
+  reset();
+}
+
+void PartitionedConvolver::reset()
+{
+  m_headPosition = 0;
+  m_position = 0;
+
+  for (auto& channel : m_channels) {
+    std::fill(channel.headHistory.begin(), channel.headHistory.end(), 0.f);
+    std::fill(channel.input.begin(), channel.input.end(), 0.f);
+    std::fill(channel.output.begin(), channel.output.end(), 0.f);
+  }
+
+  for (auto& segment : m_segments) {
+    segment.jobEnd = 0;
+    segment.jobStep = segment.getNumSteps();
+
+    for (auto& channel : segment.channels) {
+      std::fill(channel.inputSpectra.begin(), channel.inputSpectra.end(), Complex{});
+      channel.newestSpectrum = 0;
+    }
+  }
+}
+
+void PartitionedConvolver::process(float* const* channels, int numChannels, int numSamples)
+{
+  if (m_length == 0)
+    return;
+
+  numChannels = juce::jmin(numChannels, static_cast<int>(m_channels.size()));
+
+  for (int start = 0; start < numSamples;) {
+    const auto phase = static_cast<int>(m_position & (TickSize - 1));
+    if (phase == 0)
+      runTick();
+
+    const auto count = juce::jmin(numSamples - start, TickSize - phase);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      auto& state = m_channels[static_cast<size_t>(ch)];
+      auto* data = channels[ch] + start;
+      auto headPosition = m_headPosition;
+
+      for (int i = 0; i < count; ++i) {
+        const auto index = static_cast<int>((m_position + i) & m_ringMask);
+        const auto input = data[i];
+
+        state.input[static_cast<size_t>(index)] = input;
+        state.headHistory[static_cast<size_t>(headPosition)] = input;
+        state.headHistory[static_cast<size_t>(headPosition + HeadLength)] = input;
+        headPosition = (headPosition + 1) & (HeadLength - 1);
+
+        // The window runs oldest to newest, against the reversed head.
+        const auto* history = state.headHistory.data() + headPosition;
+        float sums[4] = {};
+        for (int j = 0; j < HeadLength; j += 4) {
+          sums[0] += history[j] * m_reversedHead[static_cast<size_t>(j)];
+          sums[1] += history[j + 1] * m_reversedHead[static_cast<size_t>(j + 1)];
+          sums[2] += history[j + 2] * m_reversedHead[static_cast<size_t>(j + 2)];
+          sums[3] += history[j + 3] * m_reversedHead[static_cast<size_t>(j + 3)];
+        }
+
+        auto& tail = state.output[static_cast<size_t>(index)];
+        data[i] = (sums[0] + sums[1]) + (sums[2] + sums[3]) + tail;
+        tail = 0.f;
+      }
+    }
+
+    m_headPosition = (m_headPosition + count) & (HeadLength - 1);
+    m_position += count;
+    start += count;
+  }
+}
+
+void PartitionedConvolver::runTick()
+{
+  for (auto& segment : m_segments) {
+    // A block's steps are shared out over the ticks of the next partition,
+    // which is exactly when the following block is being collected, less
+    // lag ticks at either end so the transforms land clear of the other
+    // segments'.
+    const auto ticksPerPartition = segment.partitionSize / TickSize;
+    const auto numTicks = ticksPerPartition - 2 * segment.lag;
+    const auto tick = static_cast<int>((m_position / TickSize) % ticksPerPartition) - segment.lag;
+
+    if (tick < 0 || tick >= numTicks)
+      continue;
+
+    if (tick == 0) {
+      segment.jobEnd = m_position - segment.lag * TickSize;
+      segment.jobStep = 0;
+    }
+
+    // The forward FFT leads the first tick and the inverse closes the last;
+    // the products are spread over all of them.
+    const auto numSteps = segment.getNumSteps();
+    const auto due = tick == numTicks - 1
+                         ? numSteps
+                         : 1 + ((tick + 1) * segment.numPartitions + numTicks - 1) / numTicks;
+
+    while (segment.jobStep < juce::jmin(due, numSteps))
+      runStep(segment, segment.jobStep++);
+  }
+}
+
+void PartitionedConvolver::runStep(Segment& segment, int step)
+{
+  const auto size = segment.partitionSize;
+  const auto numBins = segment.getNumBins();
+  const auto numPartitions = segment.numPartitions;
+
+  for (size_t ch = 0; ch < segment.channels.size(); ++ch) {
+    auto& channel = segment.channels[ch];
+    auto& state = m_channels[ch];
+
+    if (step == 0) {
+      // Overlap-save: the last two partitions of input, transformed into the
+      // newest slot of the delay line.
+      auto& buffer = channel.fftBuffer;
+      for (int i = 0; i < 2 * size; ++i)
+        buffer[static_cast<size_t>(i)] = state.input[static_cast<size_t>((segment.jobEnd - 2 * size + i) & m_ringMask)];
+      std::fill(buffer.begin() + 2 * size, buffer.end(), 0.f);
+
+      segment.fft->performRealOnlyForwardTransform(buffer.data(), true);
+
+      channel.newestSpectrum = (channel.newestSpectrum + 1) % numPartitions;
+      const auto* spectrum = reinterpret_cast<const Complex*>(buffer.data());
+      std::copy(spectrum, spectrum + numBins, channel.inputSpectra.begin() + channel.newestSpectrum * numBins);
+      std::fill(channel.accumulator.begin(), channel.accumulator.end(), Complex{});
+    }
+    else if (step <= numPartitions) {
+      const auto k = step - 1;
+      const auto slot = (channel.newestSpectrum - k + numPartitions) % numPartitions;
+      const auto* input = channel.inputSpectra.data() + slot * numBins;
+      const auto* impulse = segment.impulseSpectra.data() + k * numBins;
+      auto* accumulator = channel.accumulator.data();
+
+      for (int i = 0; i < numBins; ++i)
+        accumulator[i] += input[i] * impulse[i];
+    }
+    else {
+      // Only the second half of the inverse is free of circular wrap; it is
+      // the block's output, due offset samples after its input.
+      auto& buffer = channel.fftBuffer;
+      std::copy(channel.accumulator.begin(), channel.accumulator.end(), reinterpret_cast<Complex*>(buffer.data()));
+      segment.fft->performRealOnlyInverseTransform(buffer.data());
+
+      const auto first = segment.jobEnd - size + segment.offset;
+      for (int i = 0; i < size; ++i)
+        state.output[static_cast<size_t>((first + i) & m_ringMask)] += buffer[static_cast<size_t>(size + i)];
+    }
+  }
+}
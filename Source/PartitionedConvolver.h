@@ -0,0 +1,90 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Zero-latency convolution of up to two channels with one mono impulse
+// response. The first HeadLength taps run as a direct-form FIR; the rest is
+// split into uniformly partitioned FFT segments whose partitions grow four
+// times over, each starting twice its own partition size into the response
+// so its result is only due a whole partition after its input block ends.
+// That slack is used to spread each block's spectrum products over the
+// ticks of the following partition, with every segment's forward and
+// inverse FFT on a tick of its own, so long responses never stack their
+// transforms onto one callback.
+//
+// Built off the audio thread; process() and reset() never allocate.
+class PartitionedConvolver
+{
+public:
+  static constexpr int TickSize = 64;
+  static constexpr int HeadLength = 2 * TickSize;
+  static constexpr int MaxPartitionSize = 4096;
+
+  // An empty response makes process() a no-op.
+  PartitionedConvolver(const float* impulse, int length, int numChannels);
+
+  int getLength() const { return m_length; }
+
+  void reset();
+  void process(float* const* channels, int numChannels, int numSamples);
+
+private:
+  using Complex = std::complex<float>;
+
+  struct ChannelSegment
+  {
+    // Frequency-domain delay line of the last numPartitions input blocks.
+    std::vector<Complex> inputSpectra;
+    std::vector<Complex> accumulator;
+    std::vector<float> fftBuffer;
+    int newestSpectrum = 0;
+  };
+
+  struct Segment
+  {
+    int partitionSize = 0;
+    int offset = 0;
+    int numPartitions = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<Complex> impulseSpectra;
+    std::vector<ChannelSegment> channels;
+
+    // Ticks the forward FFT runs after the partition boundary, and the
+    // inverse FFT before the next one.
+    int lag = 0;
+
+    // The block being worked on ends at jobEnd; steps run from the forward
+    // FFT through one product per partition to the inverse FFT.
+    juce::int64 jobEnd = 0;
+    int jobStep = 0;
+
+    int getNumSteps() const { return numPartitions + 2; }
+    int getNumBins() const { return partitionSize + 1; }
+  };
+
+  struct ChannelState
+  {
+    // Head history, written twice so the last HeadLength inputs are always
+    // contiguous for the dot product.
+    std::vector<float> headHistory;
+    std::vector<float> input;
+    std::vector<float> output;
+  };
+
+  void runTick();
+  void runStep(Segment& segment, int step);
+
+  int m_length = 0;
+  int m_headLength = 0;
+  std::array<float, HeadLength> m_reversedHead{};
+  std::vector<Segment> m_segments;
+  std::vector<ChannelState> m_channels;
+
+  // Both rings are indexed by absolute sample position; the input one holds
+  // two of the largest partitions, the output one every contribution still
+  // ahead of the read position.
+  int m_ringMask = 0;
+  int m_headPosition = 0;
+  juce::int64 m_position = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
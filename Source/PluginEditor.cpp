@@ -2,18 +2,27 @@
 #include "PluginEditor.h"
 
 SkuxAudioProcessorEditor::SkuxAudioProcessorEditor(SkuxAudioProcessor& p)
-    : AudioProcessorEditor(&p), audioProcessor(p), oscilloscope(p.getScopeQueue())
+    : AudioProcessorEditor(&p), audioProcessor(p), scopeTaps(p.getScopeTapSlot()),
+      oscilloscope(scopeTaps->scope),
+      spectrumDisplay(scopeTaps->analyzerInput, scopeTaps->analyzerOutput, p),
+      loadMeter(p.getLoadMonitor())
 {
   setLookAndFeel(&skuxLookAndFeel);
 
   addAndMakeVisible(oscilloscope);
+  addAndMakeVisible(spectrumDisplay);
+  addAndMakeVisible(loadMeter);
 
   addAndMakeVisible(driveKnob);
   addAndMakeVisible(mixKnob);
   addAndMakeVisible(distTypeBox);
+  addAndMakeVisible(oversamplingBox);
+  addAndMakeVisible(oversamplingFilterBox);
   addAndMakeVisible(cutoffKnob);
   addAndMakeVisible(qKnob);
   addAndMakeVisible(filterRoutingBox);
+  addAndMakeVisible(filterTypeBox);
+  addAndMakeVisible(filterSlopeBox);
 
   distortionSectionLabel.setText("DISTORTION", juce::dontSendNotification);
   distortionSectionLabel.setJustificationType(juce::Justification::centred);
@@ -26,9 +35,27 @@ SkuxAudioProcessorEditor::SkuxAudioProcessorEditor(SkuxAudioProcessor& p)
   filterSectionLabel.setColour(juce::Label::textColourId, juce::Colour(0xff00e5ff));
   filterSectionLabel.setFont(juce::FontOptions(13.f, juce::Font::bold));
   addAndMakeVisible(filterSectionLabel);
+
+  presetSectionLabel.setText("PRESET", juce::dontSendNotification);
+  presetSectionLabel.setJustificationType(juce::Justification::centred);
+  presetSectionLabel.setColour(juce::Label::textColourId, juce::Colour(0xff00e5ff));
+  presetSectionLabel.setFont(juce::FontOptions(13.f, juce::Font::bold));
+  addAndMakeVisible(presetSectionLabel);
+
+  globalSectionLabel.setText("GLOBAL", juce::dontSendNotification);
+  globalSectionLabel.setJustificationType(juce::Justification::centred);
+  globalSectionLabel.setColour(juce::Label::textColourId, juce::Colour(0xff00e5ff));
+  globalSectionLabel.setFont(juce::FontOptions(13.f, juce::Font::bold));
+  addAndMakeVisible(globalSectionLabel);
   
-  distTypeBox.comboBox.addItemList({"Soft Clip", "Hard Clip"}, 1);
+  distTypeBox.comboBox.addItemList({"Soft Clip", "Hard Clip",
+                                    "Soft Clip ADAA1", "Soft Clip ADAA2",
+                                    "Hard Clip ADAA1", "Hard Clip ADAA2"}, 1);
+  oversamplingBox.comboBox.addItemList({"1x", "2x", "4x", "8x"}, 1);
+  oversamplingFilterBox.comboBox.addItemList({"Low Latency", "Linear Phase"}, 1);
   filterRoutingBox.comboBox.addItemList({"Off", "Pre", "Post"}, 1);
+  filterTypeBox.comboBox.addItemList({"High Pass", "Low Pass", "Band Pass", "Notch"}, 1);
+  filterSlopeBox.comboBox.addItemList({"12 dB", "24 dB"}, 1);
 
   driveAttachment =
     std::make_unique<SliderAttachment>(audioProcessor.apvts,
@@ -42,6 +69,14 @@ SkuxAudioProcessorEditor::SkuxAudioProcessorEditor(SkuxAudioProcessor& p)
     std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
                                          "Type",
                                          distTypeBox.comboBox);
+  oversamplingAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
+                                         "Oversampling",
+                                         oversamplingBox.comboBox);
+  oversamplingFilterAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
+                                         "Oversampling Filter",
+                                         oversamplingFilterBox.comboBox);
 
   cutoffAttachment =
     std::make_unique<SliderAttachment>(audioProcessor.apvts,
@@ -55,41 +90,513 @@ SkuxAudioProcessorEditor::SkuxAudioProcessorEditor(SkuxAudioProcessor& p)
     std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
                                          "Filter Routing",
                                          filterRoutingBox.comboBox);
+  filterTypeAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
+                                         "Filter Type",
+                                         filterTypeBox.comboBox);
+  filterSlopeAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
+                                         "Filter Slope",
+                                         filterSlopeBox.comboBox);
+
+  stereoModeBox.comboBox.addItemList({"Stereo", "Mid/Side", "Mid Only", "Side Only"}, 1);
+  sideValuesBox.comboBox.addItemList({"Linked", "Separate"}, 1);
+  addAndMakeVisible(stereoModeBox);
+  addAndMakeVisible(sideValuesBox);
+  addAndMakeVisible(sideDriveKnob);
+  addAndMakeVisible(sideMixKnob);
+  addAndMakeVisible(sideCutoffKnob);
+
+  stereoModeAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Stereo Mode", stereoModeBox.comboBox);
+  sideValuesAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Side Values", sideValuesBox.comboBox);
+  sideDriveAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Side Drive", sideDriveKnob.slider);
+  sideMixAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Side Mix", sideMixKnob.slider);
+  sideCutoffAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Side Cutoff", sideCutoffKnob.slider);
+
+  multibandBox.comboBox.addItemList({"Off", "2 Bands", "3 Bands", "4 Bands"}, 1);
+  addAndMakeVisible(multibandBox);
+  multibandAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts,
+                                         "Multiband",
+                                         multibandBox.comboBox);
+
+  for (size_t i = 0; i < crossoverKnobs.size(); ++i) {
+    crossoverKnobs[i] = std::make_unique<LabeledKnob>("XOVER " + juce::String(i + 1));
+    addAndMakeVisible(*crossoverKnobs[i]);
+    crossoverAttachments[i] =
+      std::make_unique<SliderAttachment>(audioProcessor.apvts,
+                                         "Crossover " + juce::String(i + 1),
+                                         crossoverKnobs[i]->slider);
+  }
+
+  for (size_t b = 0; b < bandControls.size(); ++b) {
+    auto& band = bandControls[b];
+    const auto prefix = "Band " + juce::String(b + 1) + " ";
+
+    band.driveKnob.label.setText("B" + juce::String(b + 1) + " DRIVE", juce::dontSendNotification);
+    band.mixKnob.label.setText("B" + juce::String(b + 1) + " MIX", juce::dontSendNotification);
+    band.typeBox.comboBox.addItemList({"Soft Clip", "Hard Clip"}, 1);
+
+    addAndMakeVisible(band.driveKnob);
+    addAndMakeVisible(band.mixKnob);
+    addAndMakeVisible(band.typeBox);
+
+    band.driveAttachment =
+      std::make_unique<SliderAttachment>(audioProcessor.apvts, prefix + "Drive", band.driveKnob.slider);
+    band.mixAttachment =
+      std::make_unique<SliderAttachment>(audioProcessor.apvts, prefix + "Mix", band.mixKnob.slider);
+    band.typeAttachment =
+      std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, prefix + "Type", band.typeBox.comboBox);
+  }
+
+  const juce::StringArray modulationTargets {"Cutoff", "Q", "Drive"};
+
+  for (size_t i = 0; i < lfoControls.size(); ++i) {
+    auto& lfo = lfoControls[i];
+    const auto prefix = "LFO " + juce::String(i + 1) + " ";
+    const auto labelPrefix = "LFO" + juce::String(i + 1) + " ";
+
+    lfo.rateKnob.label.setText(labelPrefix + "RATE", juce::dontSendNotification);
+    lfo.depthKnob.label.setText(labelPrefix + "DEPTH", juce::dontSendNotification);
+    lfo.shapeBox.label.setText(labelPrefix + "SHAPE", juce::dontSendNotification);
+    lfo.targetBox.label.setText(labelPrefix + "TARGET", juce::dontSendNotification);
+    lfo.shapeBox.comboBox.addItemList({"Sine", "Triangle", "Saw", "Square"}, 1);
+    lfo.targetBox.comboBox.addItemList(modulationTargets, 1);
+
+    addAndMakeVisible(lfo.rateKnob);
+    addAndMakeVisible(lfo.depthKnob);
+    addAndMakeVisible(lfo.shapeBox);
+    addAndMakeVisible(lfo.targetBox);
+
+    lfo.rateAttachment =
+      std::make_unique<SliderAttachment>(audioProcessor.apvts, prefix + "Rate", lfo.rateKnob.slider);
+    lfo.depthAttachment =
+      std::make_unique<SliderAttachment>(audioProcessor.apvts, prefix + "Depth", lfo.depthKnob.slider);
+    lfo.shapeAttachment =
+      std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, prefix + "Shape", lfo.shapeBox.comboBox);
+    lfo.targetAttachment =
+      std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, prefix + "Target", lfo.targetBox.comboBox);
+  }
+
+  envelopeTargetBox.comboBox.addItemList(modulationTargets, 1);
+  addAndMakeVisible(envelopeAttackKnob);
+  addAndMakeVisible(envelopeReleaseKnob);
+  addAndMakeVisible(envelopeDepthKnob);
+  addAndMakeVisible(envelopeTargetBox);
+
+  envelopeAttackAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Envelope Attack", envelopeAttackKnob.slider);
+  envelopeReleaseAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Envelope Release", envelopeReleaseKnob.slider);
+  envelopeDepthAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Envelope Depth", envelopeDepthKnob.slider);
+  envelopeTargetAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Envelope Target", envelopeTargetBox.comboBox);
+
+  sidechainDetectorBox.comboBox.addItemList({"Peak", "RMS"}, 1);
+  addAndMakeVisible(sidechainDriveKnob);
+  addAndMakeVisible(sidechainCutoffKnob);
+  addAndMakeVisible(sidechainDetectorBox);
+
+  sidechainDriveAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Sidechain Drive", sidechainDriveKnob.slider);
+  sidechainCutoffAttachment =
+    std::make_unique<SliderAttachment>(audioProcessor.apvts, "Sidechain Cutoff", sidechainCutoffKnob.slider);
+  sidechainDetectorAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Sidechain Detector", sidechainDetectorBox.comboBox);
+
+  cabinetBox.comboBox.addItemList({"Off", "On"}, 1);
+  addAndMakeVisible(cabinetBox);
+  cabinetAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Cabinet", cabinetBox.comboBox);
+
+  cabinetFileLabel.setColour(juce::Label::textColourId, juce::Colours::white.withAlpha(0.7f));
+  cabinetFileLabel.setFont(juce::FontOptions(12.f));
+
+  cabinetLoadButton.onClick = [this] {
+    cabinetChooser = std::make_unique<juce::FileChooser>("Load an impulse response",
+                                                         audioProcessor.getCabinet().getFile(),
+                                                         audioProcessor.getCabinet().getFormatWildcard());
+    cabinetChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                [this](const juce::FileChooser& chooser) {
+                                  if (chooser.getResult() != juce::File()) {
+                                    audioProcessor.getCabinet().load(chooser.getResult());
+                                    updateCabinet();
+                                  }
+                                });
+  };
+
+  cabinetClearButton.onClick = [this] {
+    audioProcessor.getCabinet().clear();
+    updateCabinet();
+  };
+
+  addAndMakeVisible(cabinetFileLabel);
+  addAndMakeVisible(cabinetLoadButton);
+  addAndMakeVisible(cabinetClearButton);
 
-  setSize(620, 440);
+  qualityBox.comboBox.addItemList({"Eco", "Normal", "High", "Auto"}, 1);
+  addAndMakeVisible(qualityBox);
+  qualityAttachment =
+    std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, "Quality", qualityBox.comboBox);
+
+  for (int target = MidiLearn::none; target < MidiLearn::NumTargets; ++target)
+    midiLearnBox.comboBox.addItem(MidiLearn::getName(static_cast<MidiLearn::Target>(target)), target + 1);
+
+  midiLearnBox.comboBox.onChange = [this] {
+    const auto target = midiLearnBox.comboBox.getSelectedId() - 1;
+    audioProcessor.getMidiLearn().learn(static_cast<MidiLearn::Target>(juce::jmax(0, target)));
+  };
+
+  midiMappingsLabel.setColour(juce::Label::textColourId, juce::Colours::white.withAlpha(0.7f));
+  midiMappingsLabel.setFont(juce::FontOptions(12.f));
+
+  midiClearButton.onClick = [this] {
+    audioProcessor.getMidiLearn().clearAll();
+    updateMidiLearn();
+  };
+
+  addAndMakeVisible(midiLearnBox);
+  addAndMakeVisible(midiMappingsLabel);
+  addAndMakeVisible(midiClearButton);
+
+  traceButton.setClickingTogglesState(true);
+  traceButton.setToggleState(audioProcessor.getTraceRecorder().isRecording(), juce::dontSendNotification);
+  traceButton.onClick = [this] {
+    auto& recorder = audioProcessor.getTraceRecorder();
+
+    if (! traceButton.getToggleState()) {
+      recorder.stop();
+      recorder.getFile().revealToUser();
+    } else if (! recorder.start(TraceRecorder::getDefaultFile())) {
+      traceButton.setToggleState(false, juce::dontSendNotification);
+    }
+  };
+  addAndMakeVisible(traceButton);
+
+  presetBox.setTextWhenNothingSelected("No preset");
+  presetBox.onChange = [this] {
+    const auto index = presetBox.getSelectedId() - 1;
+
+    if (index >= 0 && index != audioProcessor.getCurrentProgram()) {
+      audioProcessor.setCurrentProgram(index);
+      audioProcessor.updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+    }
+  };
+  addAndMakeVisible(presetBox);
+
+  presetSaveButton.onClick = [this] {
+    const auto& bank = audioProcessor.getPresetBank();
+    const auto number = bank.getNumPresets() - bank.getNumFactoryPresets() + 1;
+
+    presetNameWindow = std::make_unique<juce::AlertWindow>("Save preset", "Name the current settings:",
+                                                           juce::MessageBoxIconType::NoIcon, this);
+    presetNameWindow->addTextEditor("name", "User " + juce::String(number));
+    presetNameWindow->addButton("SAVE", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    presetNameWindow->addButton("CANCEL", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    // The callback comes asynchronously, possibly after the editor closed.
+    const auto callback = [safeThis = juce::Component::SafePointer<SkuxAudioProcessorEditor>(this)](int result) {
+      if (safeThis == nullptr || safeThis->presetNameWindow == nullptr)
+        return;
+
+      auto& window = *safeThis->presetNameWindow;
+      window.setVisible(false);
+      const auto name = window.getTextEditorContents("name").trim();
+
+      if (result == 1 && name.isNotEmpty())
+        safeThis->savePreset(name);
+    };
+    presetNameWindow->enterModalState(true, juce::ModalCallbackFunction::create(callback));
+  };
+  addAndMakeVisible(presetSaveButton);
+
+  const auto tabColour = juce::Colour(0xff0f0f23);
+  stripTabs.addTab("MID / SIDE", tabColour, stereoStrip);
+  stripTabs.addTab("MULTIBAND", tabColour, multibandStrip);
+  stripTabs.addTab("MODULATION", tabColour, modulationStrip);
+  stripTabs.addTab("CABINET", tabColour, cabinetStrip);
+  stripTabs.setCurrentTabIndex(multibandStrip, false);
+  stripTabs.addChangeListener(this);
+  addAndMakeVisible(stripTabs);
+  showStrip(stripTabs.getCurrentTabIndex());
+
+  updateMidiLearn();
+  updateCabinet();
+  updatePresets();
+  startTimerHz(10);
+
+  setResizable(true, true);
+  setResizeLimits(MinWidth, MinHeight, MaxWidth, MaxHeight);
+  setSize(DefaultWidth, DefaultHeight);
 }
 
 SkuxAudioProcessorEditor::~SkuxAudioProcessorEditor()
 {
+  stopTimer();
+  stripTabs.removeChangeListener(this);
   setLookAndFeel(nullptr);
 }
 
+void SkuxAudioProcessorEditor::timerCallback()
+{
+  updateMidiLearn();
+  updateCabinet();
+  updatePresets();
+}
+
+void SkuxAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+  showStrip(stripTabs.getCurrentTabIndex());
+}
+
+std::vector<juce::Component*> SkuxAudioProcessorEditor::getStripComponents(int strip)
+{
+  std::vector<juce::Component*> components;
+
+  switch (strip) {
+    case stereoStrip:
+      components = {&stereoModeBox, &sideValuesBox, &sideDriveKnob, &sideMixKnob, &sideCutoffKnob};
+      break;
+
+    case multibandStrip:
+      components.push_back(&multibandBox);
+      for (auto& knob : crossoverKnobs)
+        components.push_back(knob.get());
+      for (auto& band : bandControls)
+        components.insert(components.end(), {&band.driveKnob, &band.mixKnob, &band.typeBox});
+      break;
+
+    case modulationStrip:
+      for (auto& lfo : lfoControls)
+        components.insert(components.end(), {&lfo.rateKnob, &lfo.depthKnob, &lfo.shapeBox, &lfo.targetBox});
+      components.insert(components.end(), {&envelopeAttackKnob, &envelopeReleaseKnob, &envelopeDepthKnob,
+                                           &envelopeTargetBox, &sidechainDriveKnob, &sidechainCutoffKnob,
+                                           &sidechainDetectorBox});
+      break;
+
+    case cabinetStrip:
+      components = {&cabinetBox, &cabinetFileLabel, &cabinetLoadButton, &cabinetClearButton};
+      break;
+
+    default:
+      break;
+  }
+
+  return components;
+}
+
+void SkuxAudioProcessorEditor::showStrip(int strip)
+{
+  for (int s = 0; s < NumStrips; ++s)
+    for (auto* component : getStripComponents(s))
+      component->setVisible(s == strip);
+}
+
+void SkuxAudioProcessorEditor::updateMidiLearn()
+{
+  const auto& midiLearn = audioProcessor.getMidiLearn();
+  midiLearnBox.comboBox.setSelectedId(midiLearn.getLearnTarget() + 1, juce::dontSendNotification);
+
+  juce::StringArray mappings;
+
+  for (int controller = 0; controller < MidiLearn::NumControllers; ++controller) {
+    const auto target = midiLearn.getTarget(controller);
+
+    if (target != MidiLearn::none)
+      mappings.add("CC " + juce::String(controller) + " > " + MidiLearn::getName(target));
+  }
+
+  midiMappingsLabel.setText(mappings.isEmpty() ? "No CCs mapped" : mappings.joinIntoString("   "),
+                            juce::dontSendNotification);
+}
+
+void SkuxAudioProcessorEditor::updateCabinet()
+{
+  // A state restore can change the file behind the editor's back.
+  const auto file = audioProcessor.getCabinet().getFile();
+  cabinetFileLabel.setText(file == juce::File() ? "No impulse response loaded" : file.getFileName(),
+                           juce::dontSendNotification);
+}
+
+void SkuxAudioProcessorEditor::updatePresets()
+{
+  // Hosts can switch programs or restore a state without the editor.
+  const auto& bank = audioProcessor.getPresetBank();
+  juce::StringArray names;
+
+  for (int i = 0; i < bank.getNumPresets(); ++i)
+    names.add(bank.getName(i));
+
+  if (names != presetNames) {
+    presetNames = names;
+    presetBox.clear(juce::dontSendNotification);
+
+    for (int i = 0; i < names.size(); ++i) {
+      if (i == bank.getNumFactoryPresets())
+        presetBox.addSeparator();
+
+      presetBox.addItem(names[i], i + 1);
+    }
+  }
+
+  presetBox.setSelectedId(bank.getCurrentIndex() + 1, juce::dontSendNotification);
+}
+
+void SkuxAudioProcessorEditor::savePreset(const juce::String& name)
+{
+  audioProcessor.getPresetBank().addCurrent(name);
+  audioProcessor.updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+  updatePresets();
+}
+
 void SkuxAudioProcessorEditor::paint(juce::Graphics& g)
 {
   g.fillAll(juce::Colour(0xff0f0f23));
 
-  auto bounds = getLocalBounds();
-
-  const int scopeBottom = 180 + 10;
+  const auto right = static_cast<float>(getWidth() - 10);
   g.setColour(juce::Colours::white.withAlpha(0.08f));
-  g.drawHorizontalLine(scopeBottom, 10.f, static_cast<float>(bounds.getWidth() - 10));
 
-  const int controlsTop = scopeBottom + 6;
-  const int controlsBottom = bounds.getHeight() - 10;
-  const float centreX = static_cast<float>(bounds.getWidth()) / 2.f;
-  g.drawLine(centreX, static_cast<float>(controlsTop),
-             centreX, static_cast<float>(controlsBottom), 1.f);
+  for (const auto y : dividers)
+    g.drawHorizontalLine(y, 10.f, right);
+
+  const float centreX = static_cast<float>(getWidth()) / 2.f;
+  g.drawLine(centreX, static_cast<float>(controlsSpan.getStart()),
+             centreX, static_cast<float>(controlsSpan.getEnd()), 1.f);
 }
 
 void SkuxAudioProcessorEditor::resized()
 {
   auto bounds = getLocalBounds().reduced(10);
+  dividers.clearQuick();
+
+  {
+    auto area = bounds.removeFromTop(PresetHeight);
+    bounds.removeFromTop(6);
+
+    presetSectionLabel.setBounds(area.removeFromLeft(80));
+    presetSaveButton.setBounds(area.removeFromRight(80).withSizeKeepingCentre(80, 24));
+    area.removeFromRight(6);
+    presetBox.setBounds(area.removeFromLeft(240).withSizeKeepingCentre(240, 24));
+  }
 
-  oscilloscope.setBounds(bounds.removeFromTop(180));
-  bounds.removeFromTop(12);
+  {
+    auto area = bounds.removeFromBottom(GlobalHeight).reduced(6, 0);
+    bounds.removeFromBottom(12);
+    dividers.add(area.getY() - 6);
+
+    globalSectionLabel.setBounds(area.removeFromLeft(80));
+    qualityBox.setBounds(area.removeFromLeft(100));
+    area.removeFromLeft(6);
+    midiLearnBox.setBounds(area.removeFromLeft(120));
+    traceButton.setBounds(area.removeFromRight(80).withSizeKeepingCentre(80, 24));
+    area.removeFromRight(6);
+    midiClearButton.setBounds(area.removeFromRight(80).withSizeKeepingCentre(80, 24));
+    area.removeFromRight(6);
+    midiMappingsLabel.setBounds(area.reduced(6, 0));
+  }
+
+  // Every strip is laid out in the same area; showStrip() picks which one
+  // is visible.
+  auto stripArea = bounds.removeFromBottom(StripHeight).reduced(6, 0);
+  stripTabs.setBounds(bounds.removeFromBottom(TabBarHeight).reduced(6, 0));
+  bounds.removeFromBottom(12);
+  dividers.add(stripTabs.getY() - 6);
+
+  {
+    auto area = stripArea;
+    auto boxes = area.removeFromLeft(area.getWidth() / 4);
+    stereoModeBox.setBounds(boxes.removeFromTop(boxes.getHeight() / 2));
+    sideValuesBox.setBounds(boxes);
+
+    const int knobW = area.getWidth() / 3;
+    sideDriveKnob.setBounds(area.removeFromLeft(knobW));
+    sideMixKnob.setBounds(area.removeFromLeft(knobW));
+    sideCutoffKnob.setBounds(area);
+  }
+
+  {
+    auto area = stripArea;
+
+    const int boxH = 52;
+    auto crossoverArea = area.removeFromLeft(area.getWidth() / 4);
+    multibandBox.setBounds(crossoverArea.removeFromTop(boxH));
+
+    const int crossoverW = crossoverArea.getWidth() / static_cast<int>(crossoverKnobs.size());
+    for (auto& knob : crossoverKnobs)
+      knob->setBounds(crossoverArea.removeFromLeft(crossoverW));
+
+    const int bandW = area.getWidth() / static_cast<int>(bandControls.size());
+    for (auto& band : bandControls) {
+      auto column = area.removeFromLeft(bandW);
+      band.typeBox.setBounds(column.removeFromBottom(boxH));
+      band.driveKnob.setBounds(column.removeFromLeft(column.getWidth() / 2));
+      band.mixKnob.setBounds(column);
+    }
+  }
+
+  {
+    auto area = stripArea;
+
+    // One group per source; its choices stack to the right of its knobs.
+    const int boxW = 80;
+    const int numGroups = Modulator::NumLfos + 2;
+    const int numKnobs = 2 * Modulator::NumLfos + 3 + 2;
+    const int knobW = (area.getWidth() - numGroups * boxW) / numKnobs;
+
+    const auto placeGroup = [&area, boxW, knobW](std::initializer_list<LabeledKnob*> knobs,
+                                                 LabeledComboBox& topBox, LabeledComboBox* bottomBox) {
+      auto group = area.removeFromLeft(static_cast<int>(knobs.size()) * knobW + boxW);
+      auto boxes = group.removeFromRight(boxW);
+      topBox.setBounds(boxes.removeFromTop(boxes.getHeight() / 2));
+
+      if (bottomBox != nullptr)
+        bottomBox->setBounds(boxes);
+
+      for (auto* knob : knobs)
+        knob->setBounds(group.removeFromLeft(knobW));
+    };
+
+    for (auto& lfo : lfoControls)
+      placeGroup({&lfo.rateKnob, &lfo.depthKnob}, lfo.shapeBox, &lfo.targetBox);
+
+    placeGroup({&envelopeAttackKnob, &envelopeReleaseKnob, &envelopeDepthKnob}, envelopeTargetBox, nullptr);
+    placeGroup({&sidechainDriveKnob, &sidechainCutoffKnob}, sidechainDetectorBox, nullptr);
+  }
 
-  auto leftHalf = bounds.removeFromLeft(bounds.getWidth() / 2);
-  auto rightHalf = bounds;
+  {
+    auto area = stripArea.removeFromTop(CabinetHeight);
+
+    cabinetBox.setBounds(area.removeFromLeft(100));
+    cabinetClearButton.setBounds(area.removeFromRight(80).withSizeKeepingCentre(80, 24));
+    area.removeFromRight(6);
+    cabinetLoadButton.setBounds(area.removeFromRight(80).withSizeKeepingCentre(80, 24));
+    area.removeFromRight(6);
+    cabinetFileLabel.setBounds(area.reduced(6, 0));
+  }
+
+  // The scope takes whatever height the controls, at up to their full
+  // height, leave.
+  const int controlsHeight = juce::jlimit(MinControlsHeight, ControlsHeight,
+                                          bounds.getHeight() - 12 - MinScopeHeight);
+  auto controls = bounds.removeFromBottom(controlsHeight);
+  bounds.removeFromBottom(12);
+  dividers.add(controls.getY() - 6);
+  controlsSpan = { controls.getY(), controls.getBottom() };
+
+  auto scopeArea = bounds;
+  loadMeter.setBounds(scopeArea.removeFromRight(56));
+  scopeArea.removeFromRight(6);
+  oscilloscope.setBounds(scopeArea.removeFromLeft(scopeArea.getWidth() / 2 - 3));
+  scopeArea.removeFromLeft(6);
+  spectrumDisplay.setBounds(scopeArea);
+
+  auto leftHalf = controls.removeFromLeft(controls.getWidth() / 2);
+  auto rightHalf = controls;
 
   {
     auto area = leftHalf.reduced(6, 0);
@@ -101,7 +608,11 @@ void SkuxAudioProcessorEditor::resized()
 
     driveKnob.setBounds(row.removeFromLeft(knobW));
     mixKnob.setBounds(row.removeFromLeft(knobW));
-    distTypeBox.setBounds(row);
+
+    const int boxH = row.getHeight() / 3;
+    distTypeBox.setBounds(row.removeFromTop(boxH));
+    oversamplingBox.setBounds(row.removeFromTop(boxH));
+    oversamplingFilterBox.setBounds(row);
   }
   
   {
@@ -114,6 +625,10 @@ void SkuxAudioProcessorEditor::resized()
 
     cutoffKnob.setBounds(row.removeFromLeft(knobW));
     qKnob.setBounds(row.removeFromLeft(knobW));
-    filterRoutingBox.setBounds(row);
+
+    const int boxH = row.getHeight() / 3;
+    filterRoutingBox.setBounds(row.removeFromTop(boxH));
+    filterTypeBox.setBounds(row.removeFromTop(boxH));
+    filterSlopeBox.setBounds(row);
   }
 }
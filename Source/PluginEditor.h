@@ -3,11 +3,19 @@
 #include <JuceHeader.h>
 #include "LabeledComboBox.h"
 #include "LabeledKnob.h"
+#include "LoadMeter.h"
 #include "LookAndFeel.h"
 #include "Oscilloscope.h"
 #include "PluginProcessor.h"
+#include "SpectrumDisplay.h"
 
-class SkuxAudioProcessorEditor : public juce::AudioProcessorEditor
+// Resizable between MinWidth x MinHeight and MaxWidth x MaxHeight. Every
+// row has a fixed height except the scope, which takes what is left over;
+// the mid/side, multiband, modulation and cabinet strips share one tabbed
+// area so the editor fits a 768 pixel high screen.
+class SkuxAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                 private juce::Timer,
+                                 private juce::ChangeListener
 {
 public:
   SkuxAudioProcessorEditor(SkuxAudioProcessor&);
@@ -20,15 +28,48 @@ private:
   SkuxAudioProcessor& audioProcessor;
   LookAndFeel skuxLookAndFeel;
 
+  static constexpr int DefaultWidth = 760;
+  static constexpr int DefaultHeight = 720;
+  static constexpr int MinWidth = 700;
+  static constexpr int MinHeight = 660;
+  static constexpr int MaxWidth = 1400;
+  static constexpr int MaxHeight = 1200;
+
+  // The distortion and filter controls shrink to MinControlsHeight before
+  // the scope goes below MinScopeHeight.
+  static constexpr int ControlsHeight = 228;
+  static constexpr int MinControlsHeight = 190;
+  static constexpr int MinScopeHeight = 100;
+
+  // Declared ahead of the displays so the queues outlive their readers.
+  ScopeTapSlot::Lease scopeTaps;
+
+  // Preset bar across the top: picks from the bank, which is also the
+  // host's program list, and saves the current settings as a user preset.
+  static constexpr int PresetHeight = 28;
+
+  juce::Label presetSectionLabel;
+  juce::ComboBox presetBox;
+  juce::TextButton presetSaveButton{"SAVE"};
+  std::unique_ptr<juce::AlertWindow> presetNameWindow;
+  // What presetBox lists, to spot the bank changing behind its back.
+  juce::StringArray presetNames;
+
   Oscilloscope oscilloscope;
+  SpectrumDisplay spectrumDisplay;
+  LoadMeter loadMeter;
 
   LabeledKnob driveKnob{"DRIVE"};
   LabeledKnob mixKnob{"MIX"};
   LabeledComboBox distTypeBox{"TYPE"};
+  LabeledComboBox oversamplingBox{"OVERSAMPLING"};
+  LabeledComboBox oversamplingFilterBox{"OS FILTER"};
 
   LabeledKnob cutoffKnob{"CUTOFF"};
   LabeledKnob qKnob{"Q"};
   LabeledComboBox filterRoutingBox{"ROUTING"};
+  LabeledComboBox filterTypeBox{"RESPONSE"};
+  LabeledComboBox filterSlopeBox{"SLOPE"};
 
   using APVTS = juce::AudioProcessorValueTreeState;
   using SliderAttachment = APVTS::SliderAttachment;
@@ -37,12 +78,136 @@ private:
   std::unique_ptr<SliderAttachment> driveAttachment;
   std::unique_ptr<SliderAttachment> mixAttachment;
   std::unique_ptr<ComboBoxAttachment> distTypeAttachment;
+  std::unique_ptr<ComboBoxAttachment> oversamplingAttachment;
+  std::unique_ptr<ComboBoxAttachment> oversamplingFilterAttachment;
   std::unique_ptr<SliderAttachment> cutoffAttachment;
   std::unique_ptr<SliderAttachment> qAttachment;
   std::unique_ptr<ComboBoxAttachment> filterRoutingAttachment;
+  std::unique_ptr<ComboBoxAttachment> filterTypeAttachment;
+  std::unique_ptr<ComboBoxAttachment> filterSlopeAttachment;
+
+  // Tabs for the strips below the main controls; only the selected one is
+  // visible.
+  enum Strip
+  {
+    stereoStrip = 0,
+    multibandStrip,
+    modulationStrip,
+    cabinetStrip,
+    NumStrips
+  };
+
+  static constexpr int TabBarHeight = 26;
+  static constexpr int StripHeight = 196;
+
+  juce::TabbedButtonBar stripTabs{juce::TabbedButtonBar::TabsAtTop};
+
+  // Mid/side strip.
+  LabeledComboBox stereoModeBox{"STEREO MODE"};
+  LabeledComboBox sideValuesBox{"SIDE VALUES"};
+  LabeledKnob sideDriveKnob{"SIDE DRIVE"};
+  LabeledKnob sideMixKnob{"SIDE MIX"};
+  LabeledKnob sideCutoffKnob{"SIDE CUTOFF"};
+
+  std::unique_ptr<ComboBoxAttachment> stereoModeAttachment;
+  std::unique_ptr<ComboBoxAttachment> sideValuesAttachment;
+  std::unique_ptr<SliderAttachment> sideDriveAttachment;
+  std::unique_ptr<SliderAttachment> sideMixAttachment;
+  std::unique_ptr<SliderAttachment> sideCutoffAttachment;
+
+  // Multiband strip.
+  struct BandControls
+  {
+    LabeledKnob driveKnob{"DRIVE"};
+    LabeledKnob mixKnob{"MIX"};
+    LabeledComboBox typeBox{"TYPE"};
+
+    std::unique_ptr<SliderAttachment> driveAttachment;
+    std::unique_ptr<SliderAttachment> mixAttachment;
+    std::unique_ptr<ComboBoxAttachment> typeAttachment;
+  };
+
+  LabeledComboBox multibandBox{"BANDS"};
+  std::array<std::unique_ptr<LabeledKnob>, 3> crossoverKnobs;
+  std::array<BandControls, 4> bandControls;
+
+  std::unique_ptr<ComboBoxAttachment> multibandAttachment;
+  std::array<std::unique_ptr<SliderAttachment>, 3> crossoverAttachments;
+
+  // Modulation strip: the LFOs, the envelope follower and the sidechain.
+
+  struct LfoControls
+  {
+    LabeledKnob rateKnob{"RATE"};
+    LabeledKnob depthKnob{"DEPTH"};
+    LabeledComboBox shapeBox{"SHAPE"};
+    LabeledComboBox targetBox{"TARGET"};
+
+    std::unique_ptr<SliderAttachment> rateAttachment;
+    std::unique_ptr<SliderAttachment> depthAttachment;
+    std::unique_ptr<ComboBoxAttachment> shapeAttachment;
+    std::unique_ptr<ComboBoxAttachment> targetAttachment;
+  };
+
+  std::array<LfoControls, Modulator::NumLfos> lfoControls;
+
+  LabeledKnob envelopeAttackKnob{"ENV ATTACK"};
+  LabeledKnob envelopeReleaseKnob{"ENV RELEASE"};
+  LabeledKnob envelopeDepthKnob{"ENV DEPTH"};
+  LabeledComboBox envelopeTargetBox{"ENV TARGET"};
+
+  std::unique_ptr<SliderAttachment> envelopeAttackAttachment;
+  std::unique_ptr<SliderAttachment> envelopeReleaseAttachment;
+  std::unique_ptr<SliderAttachment> envelopeDepthAttachment;
+  std::unique_ptr<ComboBoxAttachment> envelopeTargetAttachment;
+
+  LabeledKnob sidechainDriveKnob{"SC DRIVE"};
+  LabeledKnob sidechainCutoffKnob{"SC CUTOFF"};
+  LabeledComboBox sidechainDetectorBox{"SC DETECTOR"};
+
+  std::unique_ptr<SliderAttachment> sidechainDriveAttachment;
+  std::unique_ptr<SliderAttachment> sidechainCutoffAttachment;
+  std::unique_ptr<ComboBoxAttachment> sidechainDetectorAttachment;
 
   juce::Label distortionSectionLabel;
   juce::Label filterSectionLabel;
 
+  // Cabinet strip: on/off and the impulse response file, which is loaded in
+  // the background.
+  static constexpr int CabinetHeight = 56;
+
+  LabeledComboBox cabinetBox{"CABINET"};
+  std::unique_ptr<ComboBoxAttachment> cabinetAttachment;
+  juce::Label cabinetFileLabel;
+  juce::TextButton cabinetLoadButton{"LOAD IR"};
+  juce::TextButton cabinetClearButton{"CLEAR"};
+  std::unique_ptr<juce::FileChooser> cabinetChooser;
+
+  // Quality and MIDI learn strip along the very bottom. The learn box arms
+  // a learn and falls back to None once the next CC has been bound.
+  static constexpr int GlobalHeight = 56;
+
+  juce::Label globalSectionLabel;
+  LabeledComboBox qualityBox{"QUALITY"};
+  std::unique_ptr<ComboBoxAttachment> qualityAttachment;
+  LabeledComboBox midiLearnBox{"MIDI LEARN"};
+  juce::Label midiMappingsLabel;
+  juce::TextButton midiClearButton{"CLEAR"};
+  // Captures a Chrome trace while down; letting go reveals the file.
+  juce::TextButton traceButton{"TRACE"};
+
+  // Where resized() put the dividers paint() draws between the rows.
+  juce::Array<int> dividers;
+  juce::Range<int> controlsSpan;
+
+  void timerCallback() override;
+  void changeListenerCallback(juce::ChangeBroadcaster*) override;
+  std::vector<juce::Component*> getStripComponents(int strip);
+  void showStrip(int strip);
+  void updateMidiLearn();
+  void updateCabinet();
+  void updatePresets();
+  void savePreset(const juce::String& name);
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SkuxAudioProcessorEditor)
 };
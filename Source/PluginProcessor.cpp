@@ -7,6 +7,7 @@ SkuxAudioProcessor::SkuxAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -16,17 +17,36 @@ SkuxAudioProcessor::SkuxAudioProcessor()
   m_distDriveParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("Drive"));
   m_distMixParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("Mix"));
   m_distTypeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Type"));
+  m_distOversamplingParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Oversampling"));
+  m_distOversamplingFilterParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Oversampling Filter"));
   
   m_distFilterCutoffParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("Filter Cutoff"));
   m_distFilterRoutingParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Filter Routing"));
   m_distFilterQParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("Filter Q"));
+  m_distFilterTypeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Filter Type"));
+  m_distFilterSlopeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Filter Slope"));
   
   jassert(m_distDriveParam != nullptr);
   jassert(m_distMixParam != nullptr);
   jassert(m_distTypeParam != nullptr);
+  jassert(m_distOversamplingParam != nullptr);
+  jassert(m_distOversamplingFilterParam != nullptr);
   jassert(m_distFilterCutoffParam != nullptr);
   jassert(m_distFilterRoutingParam != nullptr);
   jassert(m_distFilterQParam != nullptr);
+  jassert(m_distFilterTypeParam != nullptr);
+  jassert(m_distFilterSlopeParam != nullptr);
+
+  for (auto& value : m_pendingMidiValues)
+    value.store(-1.f, std::memory_order_relaxed);
+
+  for (int target = MidiLearn::none + 1; target < MidiLearn::NumTargets; ++target) {
+    const auto* id = MidiLearn::getParameterID(static_cast<MidiLearn::Target>(target));
+    m_midiTargets[static_cast<size_t>(target)] = apvts.getParameter(id);
+    m_midiSnapshotIndices[static_cast<size_t>(target)] = ParameterSnapshot::find(id);
+    jassert(m_midiTargets[static_cast<size_t>(target)] != nullptr);
+    jassert(m_midiSnapshotIndices[static_cast<size_t>(target)] != ParameterSnapshot::NumParameters);
+  }
 }
 
 SkuxAudioProcessor::~SkuxAudioProcessor() {}
@@ -65,43 +85,295 @@ bool SkuxAudioProcessor::isMidiEffect() const
 
 double SkuxAudioProcessor::getTailLengthSeconds() const
 {
-  return 0.0;
+  // The cabinet rings out for at most its longest response.
+  return apvts.getRawParameterValue("Cabinet")->load() > 0.5f ? Cabinet::MaxImpulseSeconds : 0.0;
 }
 
 int SkuxAudioProcessor::getNumPrograms()
 {
-  return 1;
+  return juce::jmax(1, m_presetBank.getNumPresets());
 }
 
 int SkuxAudioProcessor::getCurrentProgram()
 {
-  return 0;
+  return juce::jmax(0, m_presetBank.getCurrentIndex());
 }
 
-void SkuxAudioProcessor::setCurrentProgram (int index) {}
+void SkuxAudioProcessor::setCurrentProgram (int index)
+{
+  m_presetBank.select(index);
+}
 
 const juce::String SkuxAudioProcessor::getProgramName (int index)
 {
-  return {};
+  return m_presetBank.getName(index);
 }
 
-void SkuxAudioProcessor::changeProgramName (int index, const juce::String& newName) {}
+void SkuxAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+  m_presetBank.rename(index, newName);
+}
 
 void SkuxAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+  // Everything past processBlock's scheduler only ever sees one sub-block,
+  // so that, not the host's block size, is what gets allocated for. The
+  // multi-pass path's sub-block is the whole announced host block.
+  m_subBlockSize = m_multiPassProcessing ? juce::jmax(1, samplesPerBlock)
+                                         : juce::jmin(m_requestedSubBlockSize, juce::jmax(1, samplesPerBlock));
+
   juce::dsp::ProcessSpec spec;
   spec.sampleRate = sampleRate;
-  spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
+  spec.maximumBlockSize = static_cast<juce::uint32>(m_subBlockSize);
   spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
 
-  m_filterProcessor.prepare(spec);
+  const auto prepareStages = [&spec](auto& pair) {
+    for (auto& stages : pair) {
+      stages.filter.prepare(spec);
+      stages.distortion.prepare(spec);
+    }
+  };
+
+  const auto numCrossfadeChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+  if (isUsingDoublePrecision()) {
+    prepareStages(m_doubleStages);
+    m_doubleCrossfadeBuffer.setSize(numCrossfadeChannels, m_subBlockSize);
+  } else {
+    prepareStages(m_floatStages);
+    m_floatCrossfadeBuffer.setSize(numCrossfadeChannels, m_subBlockSize);
+  }
+
+  m_cabinet.prepare(sampleRate, m_subBlockSize, getTotalNumOutputChannels());
+  m_loadMonitor.prepare(sampleRate);
+  m_modulator.prepare(sampleRate, m_subBlockSize);
+  m_seedModulator = true;
+  m_autoQuality.prepare(sampleRate);
+
+  m_parameterSnapshot.update();
+  m_rampsMovedLastBlock = 0;
+  m_activeSettings = getRequestedSettings();
+  m_outgoingSettings = m_activeSettings;
+  m_crossfade.reset(sampleRate, CrossfadeSeconds);
+  m_crossfade.setCurrentAndTargetValue(1.f);
+  updateOversampling();
+
+  // Not the audio thread, so the host can hear about it right away.
+  cancelPendingUpdate();
+  setLatencySamples(m_latencySamples.load(std::memory_order_relaxed));
+
+  m_rampBuffer.setSize(NumRamps, m_subBlockSize);
+
+  m_distDriveSmoother.reset(sampleRate, SmoothingTimeSeconds);
+  m_distMixSmoother.reset(sampleRate, SmoothingTimeSeconds);
+  m_distFilterCutoffSmoother.reset(sampleRate, SmoothingTimeSeconds);
+  m_distFilterQSmoother.reset(sampleRate, SmoothingTimeSeconds);
+
+  m_distDriveSmoother.setCurrentAndTargetValue(m_distDriveParam->get());
+  m_distMixSmoother.setCurrentAndTargetValue(m_distMixParam->get());
+  m_distFilterCutoffSmoother.setCurrentAndTargetValue(m_distFilterCutoffParam->get());
+  m_distFilterQSmoother.setCurrentAndTargetValue(m_distFilterQParam->get());
+
+  using Snapshot = ParameterSnapshot;
+  m_sideDriveSmoother.reset(sampleRate, SmoothingTimeSeconds);
+  m_sideMixSmoother.reset(sampleRate, SmoothingTimeSeconds);
+  m_sideCutoffSmoother.reset(sampleRate, SmoothingTimeSeconds);
+
+  m_sideDriveSmoother.setCurrentAndTargetValue(getSideTarget(Snapshot::drive, Snapshot::sideDrive));
+  m_sideMixSmoother.setCurrentAndTargetValue(getSideTarget(Snapshot::mix, Snapshot::sideMix));
+  m_sideCutoffSmoother.setCurrentAndTargetValue(getSideTarget(Snapshot::filterCutoff, Snapshot::sideCutoff));
+
+  for (int b = 0; b < MaxBands; ++b) {
+    auto& driveSmoother = m_bandDriveSmoothers[static_cast<size_t>(b)];
+    auto& mixSmoother = m_bandMixSmoothers[static_cast<size_t>(b)];
+
+    driveSmoother.reset(sampleRate, SmoothingTimeSeconds);
+    mixSmoother.reset(sampleRate, SmoothingTimeSeconds);
+    driveSmoother.setCurrentAndTargetValue(
+      m_parameterSnapshot.get(ParameterSnapshot::band(ParameterSnapshot::band1Drive, b)));
+    mixSmoother.setCurrentAndTargetValue(
+      m_parameterSnapshot.get(ParameterSnapshot::band(ParameterSnapshot::band1Mix, b)));
+  }
 }
 
 void SkuxAudioProcessor::releaseResources()
 {
-    m_filterProcessor.reset();
+    for (size_t i = 0; i < m_floatStages.size(); ++i) {
+        m_floatStages[i].filter.reset();
+        m_floatStages[i].distortion.reset();
+        m_doubleStages[i].filter.reset();
+        m_doubleStages[i].distortion.reset();
+    }
+    m_cabinet.reset();
+    m_modulator.reset();
+}
+
+SkuxAudioProcessor::DiscreteSettings SkuxAudioProcessor::getRequestedSettings() const
+{
+  DiscreteSettings settings;
+  settings.clipType = m_parameterSnapshot.getIndex(ParameterSnapshot::clipType);
+  settings.filterRouting = m_parameterSnapshot.getIndex(ParameterSnapshot::filterRouting);
+  settings.filterType = m_parameterSnapshot.getIndex(ParameterSnapshot::filterType);
+  settings.filterSlope = m_parameterSnapshot.getIndex(ParameterSnapshot::filterSlope);
+  settings.oversampling = m_parameterSnapshot.getIndex(ParameterSnapshot::oversampling);
+  settings.oversamplingFilter = m_parameterSnapshot.getIndex(ParameterSnapshot::oversamplingFilter);
+  settings.stereoMode = m_parameterSnapshot.getIndex(ParameterSnapshot::stereoMode);
+  settings.numBands = m_parameterSnapshot.getIndex(ParameterSnapshot::multiband) + 1;
+  settings.cabinet = m_parameterSnapshot.getIndex(ParameterSnapshot::cabinet);
+  // A response loaded while the cabinet is off waits until it is turned on,
+  // and one the cabinet cannot take yet until the loader catches up.
+  settings.cabinetVersion = settings.cabinet == 1 && m_cabinet.canSwap() ? m_cabinet.getReadyVersion()
+                                                                         : m_activeSettings.cabinetVersion;
+
+  for (int b = 0; b < MaxBands; ++b) {
+    settings.bandTypes[static_cast<size_t>(b)] =
+      m_parameterSnapshot.getIndex(ParameterSnapshot::band(ParameterSnapshot::band1Type, b));
+  }
+
+  return settings;
+}
+
+Quality::Level SkuxAudioProcessor::getRequestedQuality() const
+{
+  // Offline bounces have no deadline to keep, so they always get the best.
+  if (isNonRealtime())
+    return Quality::high;
+
+  const auto quality = m_parameterSnapshot.getIndex(ParameterSnapshot::quality);
+  return quality == Quality::automatic ? m_autoQuality.getLevel() : static_cast<Quality::Level>(quality);
+}
+
+Modulator::Settings SkuxAudioProcessor::getModulationSettings() const
+{
+  using Snapshot = ParameterSnapshot;
+  Modulator::Settings settings;
+
+  for (int i = 0; i < Modulator::NumLfos; ++i) {
+    auto& lfo = settings.lfos[static_cast<size_t>(i)];
+    lfo.rate = m_parameterSnapshot.get(Snapshot::lfo(Snapshot::lfo1Rate, i));
+    lfo.shape = m_parameterSnapshot.getIndex(Snapshot::lfo(Snapshot::lfo1Shape, i));
+    lfo.destination = m_parameterSnapshot.getIndex(Snapshot::lfo(Snapshot::lfo1Target, i));
+    lfo.depth = m_parameterSnapshot.get(Snapshot::lfo(Snapshot::lfo1Depth, i));
+  }
+
+  settings.attackMs = m_parameterSnapshot.get(Snapshot::envelopeAttack);
+  settings.releaseMs = m_parameterSnapshot.get(Snapshot::envelopeRelease);
+  settings.envelopeDestination = m_parameterSnapshot.getIndex(Snapshot::envelopeTarget);
+  settings.envelopeDepth = m_parameterSnapshot.get(Snapshot::envelopeDepth);
+  settings.sidechainDriveDepth = m_parameterSnapshot.get(Snapshot::sidechainDrive);
+  settings.sidechainCutoffDepth = m_parameterSnapshot.get(Snapshot::sidechainCutoff);
+  settings.sidechainRms = m_parameterSnapshot.getIndex(Snapshot::sidechainDetector) == 1;
+  return settings;
+}
+
+float SkuxAudioProcessor::getSideTarget(ParameterSnapshot::Index mainIndex,
+                                        ParameterSnapshot::Index sideIndex) const
+{
+  const auto separate = m_parameterSnapshot.getIndex(ParameterSnapshot::sideValues) == 1;
+  return m_parameterSnapshot.get(separate ? sideIndex : mainIndex);
+}
+
+bool SkuxAudioProcessor::updateDiscreteSettings()
+{
+  // A change moves processing to the other chain, started over from silence
+  // with the new settings, and crossfades to it from the outgoing one still
+  // running the old settings. Another change waits for the crossfade to end.
+  if (m_crossfade.isSmoothing())
+    return false;
+
+  m_cabinet.finishSwap();
+  const auto requested = getRequestedSettings();
+
+  if (requested == m_activeSettings)
+    return false;
+
+  m_outgoingSettings = m_activeSettings;
+  m_activeSettings = requested;
+  m_activeStages ^= 1;
+
+  const auto restart = [](auto& stages) {
+    stages.filter.reset();
+    stages.distortion.reset();
+  };
+
+  if (isUsingDoublePrecision())
+    restart(getStages<double>(m_activeStages));
+  else
+    restart(getStages<float>(m_activeStages));
+
+  updateOversampling();
+  updateCabinet();
+  m_crossfade.setCurrentAndTargetValue(0.f);
+  m_crossfade.setTargetValue(1.f);
+  return true;
+}
+
+void SkuxAudioProcessor::updateOversampling()
+{
+  const auto linearPhase = m_activeSettings.oversamplingFilter == 1;
+
+  auto& floatDistortion = getStages<float>(m_activeStages).distortion;
+  auto& doubleDistortion = getStages<double>(m_activeStages).distortion;
+
+  floatDistortion.setOversampling(m_activeSettings.oversampling, linearPhase);
+  doubleDistortion.setOversampling(m_activeSettings.oversampling, linearPhase);
+
+  const auto latency = isUsingDoublePrecision() ? doubleDistortion.getLatencySamples()
+                                                : floatDistortion.getLatencySamples();
+  if (m_latencySamples.exchange(latency, std::memory_order_relaxed) != latency)
+    triggerAsyncUpdate();
+}
+
+void SkuxAudioProcessor::handleAsyncUpdate()
+{
+  setLatencySamples(m_latencySamples.load(std::memory_order_relaxed));
+
+  for (size_t target = 0; target < m_pendingMidiValues.size(); ++target) {
+    const auto value = m_pendingMidiValues[target].exchange(-1.f, std::memory_order_relaxed);
+    auto* parameter = m_midiTargets[target];
+
+    if (value < 0.f || parameter == nullptr)
+      continue;
+
+    parameter->beginChangeGesture();
+    parameter->setValueNotifyingHost(value);
+    parameter->endChangeGesture();
+  }
 }
 
+void SkuxAudioProcessor::updateCabinet()
+{
+  // A new response starts with an empty history. Without one, turning the
+  // cabinet on starts the old response over, unless the outgoing chain is
+  // still listening to it.
+  if (m_activeSettings.cabinet == 1) {
+    m_cabinet.swapPending();
+
+    if (m_outgoingSettings.cabinet != 1 && ! m_cabinet.isSwapping())
+      m_cabinet.reset();
+  }
+
+  m_activeSettings.cabinetVersion = m_cabinet.getActiveVersion();
+}
+
+void SkuxAudioProcessor::applyMidiController(const juce::MidiMessage& message)
+{
+  const auto target = m_midiLearn.resolve(message.getControllerNumber());
+
+  const auto index = static_cast<size_t>(target);
+  auto* parameter = m_midiTargets[index];
+
+  if (parameter == nullptr)
+    return;
+
+  // The snapshot takes the value at once, so the smoothers glide from the
+  // CC's sample on; the parameter, and with it the host and editor, follow
+  // from the message thread.
+  const auto value = static_cast<float>(message.getControllerValue()) / 127.f;
+  m_parameterSnapshot.set(m_midiSnapshotIndices[index], parameter->convertFrom0to1(value));
+  m_pendingMidiValues[index].store(value, std::memory_order_relaxed);
+  triggerAsyncUpdate();
+}
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SkuxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -122,40 +394,475 @@ bool SkuxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
 #if ! JucePlugin_IsSynth
   if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
     return false;
+
+  // The sidechain is optional and can be mono.
+  const auto sidechain = layouts.getChannelSet(true, 1);
+  if (! sidechain.isDisabled()
+      && sidechain != juce::AudioChannelSet::mono()
+      && sidechain != juce::AudioChannelSet::stereo())
+    return false;
 #endif
   return true;
 #endif
 }
 #endif
 
-void SkuxAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void SkuxAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+{
+  processChain(buffer, midi);
+}
+
+void SkuxAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midi)
+{
+  processChain(buffer, midi);
+}
+
+bool SkuxAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+  return true;
+}
+
+template <typename SampleType>
+void SkuxAudioProcessor::processChain(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi)
 {
   juce::ScopedNoDenormals noDenormals;
-  const auto totalNumInputChannels  = getTotalNumInputChannels();
-  const auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-  const auto distMix = m_distMixParam->get();
-  const auto distDrive = m_distDriveParam->get();
-  const auto distType = m_distTypeParam->getIndex();
-  const auto distFilterCutoff = m_distFilterCutoffParam->get();
-  const auto distFilterRouting = m_distFilterRoutingParam->getIndex();
-  const auto distFilterQ = m_distFilterQParam->get();
-  
-  if (distFilterRouting == 1)
-    m_filterProcessor.process(buffer, distFilterCutoff, distFilterQ, distMix);
+  const auto blockStart = juce::Time::getHighResolutionTicks();
+  const auto numMainInputChannels  = getMainBusNumInputChannels();
+  const auto numMainOutputChannels = getMainBusNumOutputChannels();
+  const auto numSamples = buffer.getNumSamples();
 
-  m_distortionProcessor.process(buffer, distDrive, distMix, distType);
+  // The chain only ever touches the main bus; the sidechain is read-only.
+  auto mainBuffer = getBusBuffer(buffer, false, 0);
+  auto sidechainBuffer = getBusCount(true) > 1 && getBus(true, 1)->isEnabled()
+                           ? getBusBuffer(buffer, true, 1)
+                           : juce::AudioBuffer<SampleType>();
 
-  if (distFilterRouting == 2)
-    m_filterProcessor.process(buffer, distFilterCutoff, distFilterQ, distMix);
-  
-  for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
-    buffer.clear(i, 0, buffer.getNumSamples());
+  for (int i = numMainInputChannels; i < numMainOutputChannels; ++i) {
+    mainBuffer.clear(i, 0, numSamples);
+  }
+
+  // The LFOs pick up at the playhead's sample rather than at zero, so
+  // renders split into chunks on separate processors meet without a jump.
+  // Only once: after that they run free, through loops and relocations.
+  if (m_seedModulator) {
+    m_seedModulator = false;
+
+    if (auto* playHead = getPlayHead()) {
+      if (const auto position = playHead->getPosition()) {
+        if (const auto time = position->getTimeInSamples()) {
+          m_modulator.setSettings(getModulationSettings());
+          m_modulator.setPosition(*time);
+        }
+      }
+    }
+  }
+
+  // Below this point the host's buffer is only ever seen in sub-blocks of
+  // at most m_subBlockSize: parameters, modulation and discrete switches are
+  // picked up at their boundaries, and every buffer prepareToPlay() sized
+  // holds one of them, whatever block size the host actually sends. Mapped
+  // CCs add a boundary at their sample; other MIDI never splits a block.
+  // Multi-pass processing gets one sub-block per host block, so each stage
+  // below runs over all of it in one pass.
+  const ScopeTapSlot::ScopedAccess taps(m_scopeTapSlot);
+  StageTimes stageTimes;
+  stageTimes.tracing = m_traceRecorder.isRecording();
+  stageTimes.hostBlockSize = numSamples;
+  auto event = midi.cbegin();
+
+  for (int start = 0; start < numSamples;) {
+    // CCs due by now move their parameters before the sub-block snapshots
+    // them, which is what makes them land on their exact sample.
+    for (; event != midi.cend(); ++event) {
+      const auto metadata = *event;
+      const auto message = metadata.getMessage();
+
+      if (! m_midiLearn.isMapped(message))
+        continue;
+
+      if (metadata.samplePosition > start)
+        break;
+
+      applyMidiController(message);
+    }
+
+    auto end = juce::jmin(start + m_subBlockSize, numSamples);
+
+    if (event != midi.cend())
+      end = juce::jmin(end, (*event).samplePosition);
+
+    const auto length = end - start;
+
+    // Both only refer to the host's channels; neither copies nor allocates.
+    juce::AudioBuffer<SampleType> subBlock(mainBuffer.getArrayOfWritePointers(),
+                                           mainBuffer.getNumChannels(), start, length);
+    const auto sidechain = sidechainBuffer.getNumChannels() > 0
+                             ? juce::AudioBuffer<SampleType>(sidechainBuffer.getArrayOfWritePointers(),
+                                                             sidechainBuffer.getNumChannels(), start, length)
+                             : juce::AudioBuffer<SampleType>();
+
+    processSubBlock(subBlock, sidechain, taps, stageTimes);
+    start = end;
+  }
+
+  for (size_t stage = 0; stage < DspLoadMonitor::wholeBlock; ++stage) {
+    if (stageTimes.ran[stage])
+      m_loadMonitor.record(static_cast<DspLoadMonitor::Stage>(stage), stageTimes.ticks[stage]);
+  }
+
+  const auto blockEnd = juce::Time::getHighResolutionTicks();
+  m_loadMonitor.finishBlock(blockEnd - blockStart, numSamples);
+
+  if (stageTimes.tracing)
+    m_traceRecorder.record(DspLoadMonitor::wholeBlock, blockStart, blockEnd, numSamples);
+
+  if (! isNonRealtime())
+    m_autoQuality.update(m_loadMonitor.getLoad(), numSamples);
+}
+
+template <typename SampleType>
+void SkuxAudioProcessor::processSubBlock(juce::AudioBuffer<SampleType>& buffer,
+                                         const juce::AudioBuffer<SampleType>& sidechain,
+                                         const ScopeTapSlot::ScopedAccess& taps,
+                                         StageTimes& stageTimes)
+{
+  const auto numSamples = buffer.getNumSamples();
+
+  using Snapshot = ParameterSnapshot;
+  auto changed = m_parameterSnapshot.update();
+
+  if (changed & Snapshot::bit(Snapshot::mix))
+    m_distMixSmoother.setTargetValue(m_parameterSnapshot.get(Snapshot::mix));
+  if (changed & Snapshot::bit(Snapshot::drive))
+    m_distDriveSmoother.setTargetValue(m_parameterSnapshot.get(Snapshot::drive));
+  if (changed & Snapshot::bit(Snapshot::filterCutoff))
+    m_distFilterCutoffSmoother.setTargetValue(m_parameterSnapshot.get(Snapshot::filterCutoff));
+  if (changed & Snapshot::bit(Snapshot::filterQ))
+    m_distFilterQSmoother.setTargetValue(m_parameterSnapshot.get(Snapshot::filterQ));
+
+  const auto sideLinkChanged = (changed & Snapshot::bit(Snapshot::sideValues)) != 0;
+
+  if (sideLinkChanged || (changed & (Snapshot::bit(Snapshot::drive) | Snapshot::bit(Snapshot::sideDrive))))
+    m_sideDriveSmoother.setTargetValue(getSideTarget(Snapshot::drive, Snapshot::sideDrive));
+  if (sideLinkChanged || (changed & (Snapshot::bit(Snapshot::mix) | Snapshot::bit(Snapshot::sideMix))))
+    m_sideMixSmoother.setTargetValue(getSideTarget(Snapshot::mix, Snapshot::sideMix));
+  if (sideLinkChanged || (changed & (Snapshot::bit(Snapshot::filterCutoff) | Snapshot::bit(Snapshot::sideCutoff))))
+    m_sideCutoffSmoother.setTargetValue(getSideTarget(Snapshot::filterCutoff, Snapshot::sideCutoff));
+
+  Snapshot::Mask bandTypeBits = 0;
+
+  for (int b = 0; b < MaxBands; ++b) {
+    const auto driveIndex = Snapshot::band(Snapshot::band1Drive, b);
+    const auto mixIndex = Snapshot::band(Snapshot::band1Mix, b);
+
+    if (changed & Snapshot::bit(driveIndex))
+      m_bandDriveSmoothers[static_cast<size_t>(b)].setTargetValue(m_parameterSnapshot.get(driveIndex));
+    if (changed & Snapshot::bit(mixIndex))
+      m_bandMixSmoothers[static_cast<size_t>(b)].setTargetValue(m_parameterSnapshot.get(mixIndex));
+
+    bandTypeBits |= Snapshot::bit(Snapshot::band(Snapshot::band1Type, b));
+  }
+
+  // Settings only count as changed once they actually switch over.
+  changed &= Snapshot::bit(Snapshot::drive) | Snapshot::bit(Snapshot::mix)
+             | Snapshot::bit(Snapshot::filterCutoff) | Snapshot::bit(Snapshot::filterQ)
+             | Snapshot::bit(Snapshot::crossover1) | Snapshot::bit(Snapshot::crossover2)
+             | Snapshot::bit(Snapshot::crossover3) | Snapshot::bit(Snapshot::sideDrive)
+             | Snapshot::bit(Snapshot::sideMix) | Snapshot::bit(Snapshot::sideCutoff);
+
+  // The outgoing chain keeps its settings, so it only ever sees these.
+  auto outgoingChanged = changed;
+
+  if (updateDiscreteSettings())
+    changed |= Snapshot::bit(Snapshot::clipType) | Snapshot::bit(Snapshot::filterRouting)
+               | Snapshot::bit(Snapshot::filterType) | Snapshot::bit(Snapshot::filterSlope)
+               | Snapshot::bit(Snapshot::oversampling) | Snapshot::bit(Snapshot::oversamplingFilter)
+               | Snapshot::bit(Snapshot::multiband) | Snapshot::bit(Snapshot::stereoMode)
+               | bandTypeBits;
+
+  const auto crossfading = m_crossfade.isSmoothing();
+
+  const auto distMix = ParameterRamp::fromSmoother(m_distMixSmoother,
+                                                   m_rampBuffer.getWritePointer(MixRamp),
+                                                   numSamples);
+  auto distDrive = ParameterRamp::fromSmoother(m_distDriveSmoother,
+                                               m_rampBuffer.getWritePointer(DriveRamp),
+                                               numSamples);
+  const auto distType = m_activeSettings.clipType;
+  auto distFilterCutoff = ParameterRamp::fromSmoother(m_distFilterCutoffSmoother,
+                                                      m_rampBuffer.getWritePointer(CutoffRamp),
+                                                      numSamples);
+  const auto distFilterRouting = m_activeSettings.filterRouting;
+  auto distFilterQ = ParameterRamp::fromSmoother(m_distFilterQSmoother,
+                                                 m_rampBuffer.getWritePointer(QRamp),
+                                                 numSamples);
+  const auto distFilterType = m_activeSettings.filterType;
+  const auto distFilterSlope = m_activeSettings.filterSlope;
+
+  MultibandParameters bands;
+  bands.numBands = m_activeSettings.numBands;
+  bands.clipType = m_activeSettings.bandTypes;
+  bands.crossovers = { m_parameterSnapshot.get(Snapshot::crossover1),
+                       m_parameterSnapshot.get(Snapshot::crossover2),
+                       m_parameterSnapshot.get(Snapshot::crossover3) };
+
+  for (int b = 0; b < MaxBands; ++b) {
+    const auto band = static_cast<size_t>(b);
+    bands.drive[band] = ParameterRamp::fromSmoother(m_bandDriveSmoothers[band],
+                                                    m_rampBuffer.getWritePointer(BandDriveRamp + b),
+                                                    numSamples);
+    bands.mix[band] = ParameterRamp::fromSmoother(m_bandMixSmoothers[band],
+                                                  m_rampBuffer.getWritePointer(BandMixRamp + b),
+                                                  numSamples);
+  }
+
+  // Side ramps are only rendered while a mid/side mode is active on either
+  // chain; otherwise their smoothers just keep time with the block.
+  StereoParameters stereo;
+  stereo.mode = m_activeSettings.stereoMode;
+
+  StereoParameters outgoingStereo;
+  outgoingStereo.mode = m_outgoingSettings.stereoMode;
+
+  const auto renderSide = stereo.isMidSide() || (crossfading && outgoingStereo.isMidSide());
+
+  if (renderSide) {
+    stereo.sideDrive = ParameterRamp::fromSmoother(m_sideDriveSmoother,
+                                                   m_rampBuffer.getWritePointer(SideDriveRamp),
+                                                   numSamples);
+    stereo.sideMix = ParameterRamp::fromSmoother(m_sideMixSmoother,
+                                                 m_rampBuffer.getWritePointer(SideMixRamp),
+                                                 numSamples);
+    stereo.sideCutoff = ParameterRamp::fromSmoother(m_sideCutoffSmoother,
+                                                    m_rampBuffer.getWritePointer(SideCutoffRamp),
+                                                    numSamples);
+  } else {
+    m_sideDriveSmoother.skip(numSamples);
+    m_sideMixSmoother.skip(numSamples);
+    m_sideCutoffSmoother.skip(numSamples);
+  }
+
+  // The modulation scales the smoothed values, rendering into their ramps.
+  m_modulator.setSettings(getModulationSettings());
+  m_modulator.process(buffer, sidechain);
+
+  if (m_modulator.isActive(Modulator::cutoff)) {
+    const auto& range = m_distFilterCutoffParam->range;
+    distFilterCutoff = ParameterRamp::modulated(distFilterCutoff, m_modulator.getGains(Modulator::cutoff),
+                                                m_rampBuffer.getWritePointer(CutoffRamp), numSamples,
+                                                range.start, range.end);
+
+    if (renderSide)
+      stereo.sideCutoff = ParameterRamp::modulated(stereo.sideCutoff, m_modulator.getGains(Modulator::cutoff),
+                                                   m_rampBuffer.getWritePointer(SideCutoffRamp), numSamples,
+                                                   range.start, range.end);
+  }
+
+  if (m_modulator.isActive(Modulator::q)) {
+    const auto& range = m_distFilterQParam->range;
+    distFilterQ = ParameterRamp::modulated(distFilterQ, m_modulator.getGains(Modulator::q),
+                                           m_rampBuffer.getWritePointer(QRamp), numSamples,
+                                           range.start, range.end);
+  }
+
+  if (m_modulator.isActive(Modulator::drive)) {
+    const auto& range = m_distDriveParam->range;
+    const auto* gains = m_modulator.getGains(Modulator::drive);
+
+    distDrive = ParameterRamp::modulated(distDrive, gains, m_rampBuffer.getWritePointer(DriveRamp),
+                                         numSamples, range.start, range.end);
+
+    if (renderSide)
+      stereo.sideDrive = ParameterRamp::modulated(stereo.sideDrive, gains,
+                                                  m_rampBuffer.getWritePointer(SideDriveRamp),
+                                                  numSamples, range.start, range.end);
+
+    const auto numModulatedBands = crossfading ? juce::jmax(bands.numBands, m_outgoingSettings.numBands)
+                                               : bands.numBands;
+
+    for (int b = 0; b < numModulatedBands; ++b) {
+      auto& bandDrive = bands.drive[static_cast<size_t>(b)];
+      bandDrive = ParameterRamp::modulated(bandDrive, gains, m_rampBuffer.getWritePointer(BandDriveRamp + b),
+                                           numSamples, range.start, range.end);
+    }
+  }
+
+  // A ramp leaves the stages with per-sample values, so it also counts as a
+  // change on the block after it settles.
+  Snapshot::Mask rampsMoving = 0;
+  if (! distDrive.isConstant())         rampsMoving |= Snapshot::bit(Snapshot::drive);
+  if (! distMix.isConstant())           rampsMoving |= Snapshot::bit(Snapshot::mix);
+  if (! distFilterCutoff.isConstant())  rampsMoving |= Snapshot::bit(Snapshot::filterCutoff);
+  if (! distFilterQ.isConstant())       rampsMoving |= Snapshot::bit(Snapshot::filterQ);
+  if (! stereo.sideDrive.isConstant())  rampsMoving |= Snapshot::bit(Snapshot::sideDrive);
+  if (! stereo.sideMix.isConstant())    rampsMoving |= Snapshot::bit(Snapshot::sideMix);
+  if (! stereo.sideCutoff.isConstant()) rampsMoving |= Snapshot::bit(Snapshot::sideCutoff);
+
+  changed |= rampsMoving | m_rampsMovedLastBlock;
+  outgoingChanged |= rampsMoving | m_rampsMovedLastBlock;
+  m_rampsMovedLastBlock = rampsMoving;
+
+  updateOversampling();
+
+  // A new level is picked up at the sub-block boundary; the stages then
+  // blend into it per sample, so there is no second chain to run for it.
+  const auto quality = getRequestedQuality();
+  auto& stages = getStages<SampleType>(m_activeStages);
+  stages.filter.setQuality(quality);
+  stages.distortion.setQuality(quality);
+
+  const ChainParameters params{distDrive, distMix, distFilterCutoff, distFilterQ,
+                               distType, distFilterRouting, distFilterType, distFilterSlope,
+                               m_activeSettings.cabinet, bands, stereo, changed};
+  juce::dsp::AudioBlock<SampleType> block(buffer);
+
+  if (! crossfading) {
+    processStages(block, params, nullptr, nullptr, taps, stageTimes);
+    return;
+  }
+
+  auto& outgoingStages = getStages<SampleType>(m_activeStages ^ 1);
+  outgoingStages.filter.setQuality(quality);
+  outgoingStages.distortion.setQuality(quality);
+
+  auto outgoingBands = bands;
+  outgoingBands.numBands = m_outgoingSettings.numBands;
+  outgoingBands.clipType = m_outgoingSettings.bandTypes;
+  outgoingStereo.sideDrive = stereo.sideDrive;
+  outgoingStereo.sideMix = stereo.sideMix;
+  outgoingStereo.sideCutoff = stereo.sideCutoff;
+
+  const ChainParameters outgoing{distDrive, distMix, distFilterCutoff, distFilterQ,
+                                 m_outgoingSettings.clipType, m_outgoingSettings.filterRouting,
+                                 m_outgoingSettings.filterType, m_outgoingSettings.filterSlope,
+                                 m_outgoingSettings.cabinet, outgoingBands, outgoingStereo,
+                                 outgoingChanged};
+
+  auto* crossfadeGains = m_rampBuffer.getWritePointer(CrossfadeRamp);
+
+  for (int s = 0; s < numSamples; ++s)
+    crossfadeGains[s] = m_crossfade.getNextValue();
+
+  processStages(block, params, &outgoing, crossfadeGains, taps, stageTimes);
+}
+
+template <typename SampleType>
+void SkuxAudioProcessor::crossfade(juce::dsp::AudioBlock<SampleType>& block,
+                                   const juce::dsp::AudioBlock<SampleType>& outgoing,
+                                   const float* gains)
+{
+  for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+    auto* data = block.getChannelPointer(ch);
+    const auto* old = outgoing.getChannelPointer(ch);
+
+    for (size_t s = 0; s < block.getNumSamples(); ++s)
+      data[s] = old[s] + (data[s] - old[s]) * static_cast<SampleType>(gains[s]);
+  }
+}
+
+template <typename SampleType>
+void SkuxAudioProcessor::processStages(juce::dsp::AudioBlock<SampleType>& block,
+                                       const ChainParameters& params,
+                                       const ChainParameters* outgoing,
+                                       const float* crossfadeGains,
+                                       const ScopeTapSlot::ScopedAccess& taps,
+                                       StageTimes& stageTimes)
+{
+  // One sub-block runs through every stage before the next one starts, so
+  // it stays in L1 from the filter to the scope push. While crossfading, the
+  // outgoing chain runs on a copy alongside; the two meet before the shared
+  // cabinet and again after the post filter.
+  auto& stages = getStages<SampleType>(m_activeStages);
+  auto& outgoingStages = getStages<SampleType>(m_activeStages ^ 1);
+  auto ticks = juce::Time::getHighResolutionTicks();
+
+  const auto lap = [this, &stageTimes, &ticks](DspLoadMonitor::Stage stage) {
+    const auto now = juce::Time::getHighResolutionTicks();
+    stageTimes.ticks[stage] += now - ticks;
+    stageTimes.ran[stage] = true;
+
+    if (stageTimes.tracing)
+      m_traceRecorder.record(stage, ticks, now, stageTimes.hostBlockSize);
+
+    ticks = now;
+  };
+
+  const auto filter = [&lap](auto& chain, auto& target, const ChainParameters& p, int routing) {
+    if (p.filterRouting == routing) {
+      chain.filter.process(target, p.cutoff, p.q, p.mix, p.stereo, p.filterType, p.filterSlope,
+                           p.filterChanged());
+      lap(routing == 1 ? DspLoadMonitor::preFilter : DspLoadMonitor::postFilter);
+    }
+  };
+
+  const auto distort = [&lap](auto& chain, auto& target, const ChainParameters& p) {
+    if (p.isMultiband())
+      chain.distortion.processMultiband(target, p.bands, p.stereo, p.crossoversChanged());
+    else
+      chain.distortion.process(target, p.drive, p.mix, p.clipType, p.stereo, p.distortionChanged());
+
+    lap(DspLoadMonitor::distortion);
+  };
+
+  juce::dsp::AudioBlock<SampleType> old;
+
+  if (outgoing != nullptr) {
+    old = juce::dsp::AudioBlock<SampleType>(getCrossfadeBuffer<SampleType>())
+            .getSubsetChannelBlock(0, block.getNumChannels())
+            .getSubBlock(0, block.getNumSamples());
+    old.copyFrom(block);
+  }
+
+  filter(stages, block, params, 1);
+
+  if (taps) {
+    taps->analyzerInput.push(block);
+    lap(DspLoadMonitor::scopePush);
+  }
+
+  distort(stages, block, params);
+
+  if (outgoing != nullptr) {
+    filter(outgoingStages, old, *outgoing, 1);
+    distort(outgoingStages, old, *outgoing);
+    crossfade(block, old, crossfadeGains);
+  }
+
+  // The cabinet has one history, so unless the outgoing chain is fading out
+  // a replaced response, it runs once per block on whichever signals need it.
+  const auto cabinet = params.cabinet == 1;
+  const auto outgoingCabinet = outgoing != nullptr && outgoing->cabinet == 1;
+
+  if (outgoing != nullptr)
+    old.copyFrom(block);
+
+  if (cabinet)
+    m_cabinet.process(block);
+
+  if (outgoingCabinet) {
+    if (m_cabinet.isSwapping())
+      m_cabinet.processOutgoing(old);
+    else if (cabinet)
+      old.copyFrom(block);
+    else
+      m_cabinet.process(old);
+  }
+
+  if (cabinet || outgoingCabinet)
+    lap(DspLoadMonitor::cabinet);
+
+  filter(stages, block, params, 2);
+
+  if (outgoing != nullptr) {
+    filter(outgoingStages, old, *outgoing, 2);
+    crossfade(block, old, crossfadeGains);
+  }
+
+  if (taps) {
+    taps->scope.push(block);
+    taps->analyzerOutput.push(block);
+    lap(DspLoadMonitor::scopePush);
   }
-  
-  m_scopeQueue.push(
-    buffer.getReadPointer(0),
-    static_cast<size_t>(buffer.getNumSamples()));
 }
 
 bool SkuxAudioProcessor::hasEditor() const
@@ -171,13 +878,36 @@ juce::AudioProcessorEditor* SkuxAudioProcessor::createEditor()
 
 void SkuxAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-  auto state = apvts.copyState();
-  auto xml = state.createXml();
-  copyXmlToBinary(*xml, destData);
+  m_parameterState.write(destData);
+  m_midiLearn.write(destData);
+  m_cabinet.write(destData);
+  m_presetBank.write(destData);
 }
 
 void SkuxAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+  if (m_parameterState.read(data, sizeInBytes)) {
+    const auto* bytes = static_cast<const char*>(data);
+    const auto stateSize = ParameterState::getSizeInBytes(data);
+    m_midiLearn.read(bytes + stateSize, static_cast<size_t>(sizeInBytes) - stateSize);
+
+    // Each chunk is optional, so older states simply run out early.
+    const auto cabinetOffset = juce::jmin(stateSize + MidiLearn::StateSize, static_cast<size_t>(sizeInBytes));
+    m_cabinet.read(bytes + cabinetOffset, static_cast<size_t>(sizeInBytes) - cabinetOffset);
+
+    const auto presetOffset = cabinetOffset + Cabinet::getStateSize(bytes + cabinetOffset,
+                                                                     static_cast<size_t>(sizeInBytes) - cabinetOffset);
+    m_presetBank.read(bytes + presetOffset, static_cast<size_t>(sizeInBytes) - presetOffset);
+    updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+    return;
+  }
+
+  m_midiLearn.clearAll();
+  m_cabinet.clear();
+  m_presetBank.clear();
+  updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withProgramChanged(true));
+
+  // States saved before the binary format were APVTS XML.
   auto xml = getXmlFromBinary(data, sizeInBytes);
   if (xml != nullptr && xml->hasTagName(apvts.state.getType()))
     apvts.replaceState(juce::ValueTree::fromXml(*xml));
@@ -204,18 +934,145 @@ juce::AudioProcessorValueTreeState::ParameterLayout SkuxAudioProcessor::createPa
                                                          "Filter Q",
                                                          juce::NormalisableRange<float>(0.707f, 10.f, 0.01f, 0.5f),
                                                          0.707f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Filter Type", 1),
+                                                          "Filter Type",
+                                                          juce::StringArray { "High Pass", "Low Pass", "Band Pass", "Notch" },
+                                                          0));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Filter Slope", 1),
+                                                          "Filter Slope",
+                                                          juce::StringArray { "12 dB", "24 dB" },
+                                                          1));
   layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Type", 1),
                                                           "Type",
-                                                          juce::StringArray { "Soft Clip", "Hard Clip" },
+                                                          juce::StringArray { "Soft Clip", "Hard Clip",
+                                                                             "Soft Clip ADAA1", "Soft Clip ADAA2",
+                                                                             "Hard Clip ADAA1", "Hard Clip ADAA2" },
                                                           0));
   layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Drive", 1),
                                                          "Drive",
                                                          juce::NormalisableRange<float>(1.f, 12.f, 0.01f, 0.5f),
                                                          1.f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Oversampling", 1),
+                                                          "Oversampling",
+                                                          juce::StringArray { "1x", "2x", "4x", "8x" },
+                                                          0));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Oversampling Filter", 1),
+                                                          "Oversampling Filter",
+                                                          juce::StringArray { "Low Latency", "Linear Phase" },
+                                                          0));
   layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mix", 1),
                                                          "Mix",
                                                          juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
                                                          0.f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Multiband", 1),
+                                                          "Multiband",
+                                                          juce::StringArray { "Off", "2 Bands", "3 Bands", "4 Bands" },
+                                                          0));
+
+  const std::array<float, MaxBands - 1> crossoverDefaults { 200.f, 1000.f, 5000.f };
+
+  for (int i = 0; i < MaxBands - 1; ++i) {
+    const auto name = "Crossover " + juce::String(i + 1);
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(name, 1),
+                                                           name,
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                           crossoverDefaults[static_cast<size_t>(i)]));
+  }
+
+  for (int b = 0; b < MaxBands; ++b) {
+    const auto prefix = "Band " + juce::String(b + 1) + " ";
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "Drive", 1),
+                                                           prefix + "Drive",
+                                                           juce::NormalisableRange<float>(1.f, 12.f, 0.01f, 0.5f),
+                                                           1.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "Mix", 1),
+                                                           prefix + "Mix",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           1.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID(prefix + "Type", 1),
+                                                            prefix + "Type",
+                                                            juce::StringArray { "Soft Clip", "Hard Clip" },
+                                                            0));
+  }
+
+  const juce::StringArray modulationTargets { "Cutoff", "Q", "Drive" };
+
+  for (int i = 0; i < Modulator::NumLfos; ++i) {
+    const auto prefix = "LFO " + juce::String(i + 1) + " ";
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "Rate", 1),
+                                                           prefix + "Rate",
+                                                           juce::NormalisableRange<float>(0.01f, 20.f, 0.01f, 0.3f),
+                                                           1.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID(prefix + "Shape", 1),
+                                                            prefix + "Shape",
+                                                            juce::StringArray { "Sine", "Triangle", "Saw", "Square" },
+                                                            0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID(prefix + "Target", 1),
+                                                            prefix + "Target",
+                                                            modulationTargets,
+                                                            0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "Depth", 1),
+                                                           prefix + "Depth",
+                                                           juce::NormalisableRange<float>(-1.f, 1.f, 0.01f, 1.f),
+                                                           0.f));
+  }
+
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Envelope Attack", 1),
+                                                         "Envelope Attack",
+                                                         juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.4f),
+                                                         5.f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Envelope Release", 1),
+                                                         "Envelope Release",
+                                                         juce::NormalisableRange<float>(5.f, 1000.f, 1.f, 0.4f),
+                                                         100.f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Envelope Target", 1),
+                                                          "Envelope Target",
+                                                          modulationTargets,
+                                                          0));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Envelope Depth", 1),
+                                                         "Envelope Depth",
+                                                         juce::NormalisableRange<float>(-1.f, 1.f, 0.01f, 1.f),
+                                                         0.f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Sidechain Drive", 1),
+                                                         "Sidechain Drive",
+                                                         juce::NormalisableRange<float>(-1.f, 1.f, 0.01f, 1.f),
+                                                         0.f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Sidechain Cutoff", 1),
+                                                         "Sidechain Cutoff",
+                                                         juce::NormalisableRange<float>(-1.f, 1.f, 0.01f, 1.f),
+                                                         0.f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Sidechain Detector", 1),
+                                                          "Sidechain Detector",
+                                                          juce::StringArray { "Peak", "RMS" },
+                                                          0));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Stereo Mode", 1),
+                                                          "Stereo Mode",
+                                                          juce::StringArray { "Stereo", "Mid/Side", "Mid Only", "Side Only" },
+                                                          0));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Side Values", 1),
+                                                          "Side Values",
+                                                          juce::StringArray { "Linked", "Separate" },
+                                                          0));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side Drive", 1),
+                                                         "Side Drive",
+                                                         juce::NormalisableRange<float>(1.f, 12.f, 0.01f, 0.5f),
+                                                         1.f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side Mix", 1),
+                                                         "Side Mix",
+                                                         juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                         0.f));
+  layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side Cutoff", 1),
+                                                         "Side Cutoff",
+                                                         juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                         20000.f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Quality", 1),
+                                                          "Quality",
+                                                          juce::StringArray { "Eco", "Normal", "High", "Auto" },
+                                                          1));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Cabinet", 1),
+                                                          "Cabinet",
+                                                          juce::StringArray { "Off", "On" },
+                                                          0));
 
   return layout;
 }
@@ -1,14 +1,20 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Cabinet.h"
 #include "Filter.h"
 #include "Distortion.h"
-#include "ScopeDataQueue.h"
+#include "DspLoadMonitor.h"
+#include "MidiLearn.h"
+#include "Modulator.h"
+#include "ParameterSnapshot.h"
+#include "ParameterState.h"
+#include "PresetBank.h"
+#include "ScopeTaps.h"
+#include "TraceRecorder.h"
 
-inline constexpr size_t ScopeBlockSize = 512;
-inline constexpr int ScopeNumBlocks = 30;
-
-class SkuxAudioProcessor  : public juce::AudioProcessor
+class SkuxAudioProcessor  : public juce::AudioProcessor,
+                            private juce::AsyncUpdater
 {
 public:
   SkuxAudioProcessor();
@@ -22,6 +28,8 @@ public:
 #endif
 
   void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+  void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+  bool supportsDoublePrecisionProcessing() const override;
 
   juce::AudioProcessorEditor* createEditor() override;
   bool hasEditor() const override;
@@ -47,22 +55,281 @@ public:
   
   APVTS apvts{*this, nullptr, "Parameters", createParameterLayout()};
   
-  ScopeDataQueue<ScopeBlockSize, ScopeNumBlocks>& getScopeQueue() {
-    return m_scopeQueue;
+  // The editor leases its scope and analyzer queues from here; the analyzer
+  // taps sit just before the distortion and at the output.
+  ScopeTapSlot& getScopeTapSlot() {
+    return m_scopeTapSlot;
+  }
+
+  // Message thread only; also backs the host-facing program list.
+  PresetBank& getPresetBank() {
+    return m_presetBank;
+  }
+
+  // Per-stage processBlock timings; exportJSON() dumps the histograms.
+  DspLoadMonitor& getLoadMonitor() {
+    return m_loadMonitor;
+  }
+
+  // Opt-in Chrome trace of every block and stage; message thread starts
+  // and stops it.
+  TraceRecorder& getTraceRecorder() {
+    return m_traceRecorder;
+  }
+
+  // CC mappings; editable from any thread, applied on the event's sample.
+  MidiLearn& getMidiLearn() {
+    return m_midiLearn;
   }
+
+  // Impulse response for the Cabinet stage; the message thread loads it.
+  Cabinet& getCabinet() {
+    return m_cabinet;
+  }
+
+  // Length of the internal sub-blocks processBlock slices host buffers into,
+  // clamped to [1, MaxSubBlockSize]. Takes effect at the next prepareToPlay();
+  // output does not depend on it, only cost and control granularity do.
+  void setSubBlockSize(int numSamples) {
+    m_requestedSubBlockSize = juce::jlimit(1, MaxSubBlockSize, numSamples);
+  }
+
+  // The reference path: each stage makes one pass over the whole host block
+  // before the next one starts, with parameters read once per block. Slower,
+  // but what the sub-block scheduler is verified against. Takes effect at the
+  // next prepareToPlay().
+  void setMultiPassProcessing(bool shouldUseMultiPass) {
+    m_multiPassProcessing = shouldUseMultiPass;
+  }
+
+  static constexpr int DefaultSubBlockSize = 64;
+  static constexpr int MaxSubBlockSize = 8192;
 private:
-  Filter m_filterProcessor;
-  Distortion m_distortionProcessor;
+  // Two chains per precision; only the pair the host asked for is prepared.
+  // A discrete change crossfades from the active one to the other.
+  template <typename SampleType>
+  struct Stages
+  {
+    Filter<SampleType> filter;
+    Distortion<SampleType> distortion;
+  };
+
+  std::array<Stages<float>, 2> m_floatStages;
+  std::array<Stages<double>, 2> m_doubleStages;
+  int m_activeStages = 0;
+
+  template <typename SampleType>
+  Stages<SampleType>& getStages(int index)
+  {
+    if constexpr (std::is_same_v<SampleType, double>)
+      return m_doubleStages[static_cast<size_t>(index)];
+    else
+      return m_floatStages[static_cast<size_t>(index)];
+  }
+
+  // The outgoing chain's copy of each sub-block during a crossfade.
+  juce::AudioBuffer<float> m_floatCrossfadeBuffer;
+  juce::AudioBuffer<double> m_doubleCrossfadeBuffer;
+
+  template <typename SampleType>
+  juce::AudioBuffer<SampleType>& getCrossfadeBuffer()
+  {
+    if constexpr (std::is_same_v<SampleType, double>)
+      return m_doubleCrossfadeBuffer;
+    else
+      return m_floatCrossfadeBuffer;
+  }
   
   juce::AudioParameterFloat *m_distDriveParam{nullptr};
   juce::AudioParameterFloat *m_distMixParam{nullptr};
   juce::AudioParameterChoice* m_distTypeParam{nullptr};
+  juce::AudioParameterChoice* m_distOversamplingParam{nullptr};
+  juce::AudioParameterChoice* m_distOversamplingFilterParam{nullptr};
   
   juce::AudioParameterFloat* m_distFilterCutoffParam{nullptr};
   juce::AudioParameterChoice* m_distFilterRoutingParam{nullptr};
   juce::AudioParameterFloat* m_distFilterQParam{nullptr};
+  juce::AudioParameterChoice* m_distFilterTypeParam{nullptr};
+  juce::AudioParameterChoice* m_distFilterSlopeParam{nullptr};
+
+  MidiLearn m_midiLearn;
+  std::array<juce::RangedAudioParameter*, MidiLearn::NumTargets> m_midiTargets{};
+  std::array<ParameterSnapshot::Index, MidiLearn::NumTargets> m_midiSnapshotIndices{};
+  // Normalised CC values the host has yet to hear about, or -1. The audio
+  // thread writes them, handleAsyncUpdate() passes them on as gestures.
+  std::array<std::atomic<float>, MidiLearn::NumTargets> m_pendingMidiValues;
+
+  // Shared by both precisions; it converts double blocks itself.
+  Cabinet m_cabinet;
+  
+  // Continuous parameters glide over this time instead of stepping once per
+  // block; the stages only pay for per-sample values while a glide is running.
+  static constexpr double SmoothingTimeSeconds = 0.02;
+
+  static constexpr int MaxBands = MultibandParameters::MaxBands;
+
+  enum RampChannel
+  {
+    DriveRamp,
+    MixRamp,
+    CutoffRamp,
+    QRamp,
+    SideDriveRamp,
+    SideMixRamp,
+    SideCutoffRamp,
+    BandDriveRamp,
+    BandMixRamp = BandDriveRamp + MaxBands,
+    CrossfadeRamp = BandMixRamp + MaxBands,
+    NumRamps
+  };
+
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> m_distDriveSmoother;
+  juce::SmoothedValue<float> m_distMixSmoother;
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> m_distFilterCutoffSmoother;
+  juce::SmoothedValue<float> m_distFilterQSmoother;
+  // Side values for the mid/side modes. While linked they glide to the main
+  // targets instead, so toggling the link never steps.
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> m_sideDriveSmoother;
+  juce::SmoothedValue<float> m_sideMixSmoother;
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> m_sideCutoffSmoother;
+  std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>, MaxBands> m_bandDriveSmoothers;
+  std::array<juce::SmoothedValue<float>, MaxBands> m_bandMixSmoothers;
+  juce::AudioBuffer<float> m_rampBuffer;
+
+  // Control-rate LFOs and envelope follower scaling Cutoff, Q and Drive.
+  Modulator m_modulator;
+  // Set by prepareToPlay(); the next block starts the LFOs from the playhead.
+  bool m_seedModulator = false;
+
+  // Discrete parameters switch over with a crossfade: the outgoing chain
+  // keeps running the old settings while the other one starts over with the
+  // new, so switching presets or clip types never clicks or drops out.
+  struct DiscreteSettings
+  {
+    int clipType = 0;
+    int filterRouting = 0;
+    int filterType = 0;
+    int filterSlope = 0;
+    int oversampling = 0;
+    int oversamplingFilter = 0;
+    int stereoMode = StereoParameters::stereo;
+    int cabinet = 0;
+    // The loaded response the cabinet should be running; a new one starts
+    // from an empty history and is crossfaded in against the old one.
+    juce::uint32 cabinetVersion = 0;
+    int numBands = 1;
+    std::array<int, MaxBands> bandTypes{};
+
+    bool operator==(const DiscreteSettings&) const = default;
+  };
+
+  static constexpr double CrossfadeSeconds = 0.005;
+
+  DiscreteSettings m_activeSettings;
+  DiscreteSettings m_outgoingSettings;
+  // Weight of the active chain, rising from 0 to 1 after a switch.
+  juce::SmoothedValue<float> m_crossfade;
+
+  // Latency of the active oversampling. The audio thread only records it;
+  // handleAsyncUpdate() reports it to the host from the message thread,
+  // along with any MIDI-learned parameter changes.
+  std::atomic<int> m_latencySamples{ 0 };
+
+  // Level the Auto quality setting runs at. Quality is not a discrete
+  // setting: a step only swaps curves and warping that agree to well below
+  // a click, so it applies straight away at the next sub-block.
+  AutoQuality m_autoQuality;
+
+  // What processBlock reads parameters through; the changed bits decide
+  // which stages rebuild their derived coefficients.
+  ParameterSnapshot m_parameterSnapshot{apvts};
+  ParameterSnapshot::Mask m_rampsMovedLastBlock = 0;
+
+  ParameterState m_parameterState{apvts};
+  PresetBank m_presetBank{m_parameterState};
+
+  struct ChainParameters
+  {
+    ParameterRamp drive, mix, cutoff, q;
+    int clipType, filterRouting, filterType, filterSlope, cabinet;
+    MultibandParameters bands;
+    StereoParameters stereo;
+    ParameterSnapshot::Mask changed;
+
+    bool isMultiband() const { return bands.numBands > 1; }
+
+    // The filter is skipped while unrouted, so routing it counts as well.
+    bool filterChanged() const
+    {
+      return (changed & (ParameterSnapshot::bit(ParameterSnapshot::filterCutoff)
+                         | ParameterSnapshot::bit(ParameterSnapshot::filterQ)
+                         | ParameterSnapshot::bit(ParameterSnapshot::filterRouting)
+                         | ParameterSnapshot::bit(ParameterSnapshot::sideCutoff)
+                         | ParameterSnapshot::bit(ParameterSnapshot::stereoMode))) != 0;
+    }
+
+    bool distortionChanged() const
+    {
+      return (changed & (ParameterSnapshot::bit(ParameterSnapshot::drive)
+                         | ParameterSnapshot::bit(ParameterSnapshot::mix)
+                         | ParameterSnapshot::bit(ParameterSnapshot::clipType)
+                         | ParameterSnapshot::bit(ParameterSnapshot::sideDrive)
+                         | ParameterSnapshot::bit(ParameterSnapshot::sideMix)
+                         | ParameterSnapshot::bit(ParameterSnapshot::stereoMode))) != 0;
+    }
+
+    bool crossoversChanged() const
+    {
+      return (changed & (ParameterSnapshot::bit(ParameterSnapshot::multiband)
+                         | ParameterSnapshot::bit(ParameterSnapshot::crossover1)
+                         | ParameterSnapshot::bit(ParameterSnapshot::crossover2)
+                         | ParameterSnapshot::bit(ParameterSnapshot::crossover3))) != 0;
+    }
+  };
+
+  // Per-stage ticks summed over one callback's sub-blocks, recorded once.
+  // While a trace is running every lap also goes to it individually.
+  struct StageTimes
+  {
+    std::array<juce::int64, DspLoadMonitor::NumStages> ticks{};
+    std::array<bool, DspLoadMonitor::NumStages> ran{};
+    bool tracing = false;
+    int hostBlockSize = 0;
+  };
+
+  // The default is small enough that a stereo sub-block stays in L1 across
+  // all stages, even at 8x oversampling.
+  int m_requestedSubBlockSize = DefaultSubBlockSize;
+  int m_subBlockSize = DefaultSubBlockSize;
+  bool m_multiPassProcessing = false;
   
-  ScopeDataQueue<ScopeBlockSize, ScopeNumBlocks> m_scopeQueue;
+  ScopeTapSlot m_scopeTapSlot;
+  DspLoadMonitor m_loadMonitor;
+  TraceRecorder m_traceRecorder;
+
+  DiscreteSettings getRequestedSettings() const;
+  Quality::Level getRequestedQuality() const;
+  Modulator::Settings getModulationSettings() const;
+  float getSideTarget(ParameterSnapshot::Index mainIndex, ParameterSnapshot::Index sideIndex) const;
+  bool updateDiscreteSettings();
+  void updateOversampling();
+  void handleAsyncUpdate() override;
+  void updateCabinet();
+  void applyMidiController(const juce::MidiMessage& message);
+  template <typename SampleType>
+  void processChain(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midi);
+  template <typename SampleType>
+  void processSubBlock(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& sidechain,
+                       const ScopeTapSlot::ScopedAccess& taps, StageTimes& stageTimes);
+  // outgoing and crossfadeGains are only set while a discrete change
+  // crossfades; the gains are the active chain's weight per sample.
+  template <typename SampleType>
+  void processStages(juce::dsp::AudioBlock<SampleType>& block, const ChainParameters& params,
+                     const ChainParameters* outgoing, const float* crossfadeGains,
+                     const ScopeTapSlot::ScopedAccess& taps, StageTimes& stageTimes);
+  template <typename SampleType>
+  static void crossfade(juce::dsp::AudioBlock<SampleType>& block,
+                        const juce::dsp::AudioBlock<SampleType>& outgoing, const float* gains);
   
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SkuxAudioProcessor)
 };
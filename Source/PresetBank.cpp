@@ -0,0 +1,141 @@
+#include "PresetBank.h"
+
+PresetBank::PresetBank(const ParameterState& state) : m_state(state)
+{
+  addFactoryPresets();
+}
+
+void PresetBank::addFactoryPresets()
+{
+  // Choices are given by index, everything else unnormalised.
+  const auto addFactory = [this](const char* name, std::initializer_list<std::pair<const char*, float>> values) {
+    m_presets.push_back({ name, m_state.make(values) });
+  };
+
+  addFactory("Init", {});
+  addFactory("Warm Tape", { { "Type", 2.f }, { "Drive", 3.f }, { "Mix", 0.8f }, { "Oversampling", 1.f },
+                            { "Filter Routing", 2.f }, { "Filter Type", 1.f }, { "Filter Cutoff", 9000.f } });
+  addFactory("Fuzz", { { "Type", 5.f }, { "Drive", 10.f }, { "Oversampling", 2.f },
+                       { "Filter Routing", 1.f }, { "Filter Type", 0.f }, { "Filter Cutoff", 120.f } });
+  addFactory("Telephone", { { "Type", 1.f }, { "Drive", 6.f }, { "Filter Routing", 2.f }, { "Filter Type", 2.f },
+                            { "Filter Cutoff", 1500.f }, { "Filter Q", 2.f }, { "Filter Slope", 1.f } });
+  addFactory("Auto Wah", { { "Drive", 4.f }, { "Filter Routing", 2.f }, { "Filter Type", 2.f },
+                           { "Filter Cutoff", 600.f }, { "Filter Q", 4.f }, { "Envelope Target", 0.f },
+                           { "Envelope Depth", 0.8f }, { "Envelope Release", 150.f } });
+  addFactory("Tremolo Grit", { { "Drive", 5.f }, { "LFO 1 Rate", 5.f }, { "LFO 1 Target", 2.f },
+                               { "LFO 1 Depth", 0.6f } });
+  addFactory("Multiband Glue", { { "Multiband", 2.f }, { "Band 1 Drive", 2.f }, { "Band 1 Mix", 0.5f },
+                                 { "Band 2 Drive", 4.f }, { "Band 2 Mix", 0.7f }, { "Band 3 Drive", 3.f },
+                                 { "Band 3 Mix", 0.4f }, { "Band 3 Type", 1.f } });
+  addFactory("Wide Side", { { "Drive", 3.f }, { "Stereo Mode", 1.f }, { "Side Values", 1.f },
+                            { "Side Drive", 8.f }, { "Side Mix", 0.8f } });
+
+  m_numFactoryPresets = getNumPresets();
+}
+
+int PresetBank::addCurrent(const juce::String& name)
+{
+  m_presets.push_back({ name, m_state.capture() });
+  m_currentIndex = getNumPresets() - 1;
+  return m_currentIndex;
+}
+
+int PresetBank::add(const juce::String& name, const void* data, int sizeInBytes)
+{
+  Preset preset{ name, {} };
+
+  if (! m_state.decode(data, sizeInBytes, preset.values))
+    return -1;
+
+  m_presets.push_back(std::move(preset));
+  return getNumPresets() - 1;
+}
+
+bool PresetBank::select(int index)
+{
+  if (! juce::isPositiveAndBelow(index, getNumPresets()))
+    return false;
+
+  m_state.apply(m_presets[static_cast<size_t>(index)].values);
+  m_currentIndex = index;
+  return true;
+}
+
+void PresetBank::rename(int index, const juce::String& name)
+{
+  if (juce::isPositiveAndBelow(index, getNumPresets()))
+    m_presets[static_cast<size_t>(index)].name = name;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+  return juce::isPositiveAndBelow(index, getNumPresets()) ? m_presets[static_cast<size_t>(index)].name
+                                                          : juce::String();
+}
+
+const std::vector<float>& PresetBank::getValues(int index) const
+{
+  jassert(juce::isPositiveAndBelow(index, getNumPresets()));
+  return m_presets[static_cast<size_t>(juce::jlimit(0, getNumPresets() - 1, index))].values;
+}
+
+void PresetBank::write(juce::MemoryBlock& dest) const
+{
+  juce::MemoryBlock chunk;
+
+  for (size_t i = static_cast<size_t>(m_numFactoryPresets); i < m_presets.size(); ++i) {
+    const auto& preset = m_presets[i];
+    const auto numBytes = preset.name.getNumBytesAsUTF8();
+    const auto size = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(numBytes));
+
+    chunk.append(&size, sizeof(size));
+    chunk.append(preset.name.toRawUTF8(), numBytes);
+    m_state.append(preset.values, chunk);
+  }
+
+  const auto magic = juce::ByteOrder::swapIfBigEndian(Magic);
+  const auto size = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(chunk.getSize()));
+
+  dest.append(&magic, sizeof(magic));
+  dest.append(&size, sizeof(size));
+  dest.append(chunk.getData(), chunk.getSize());
+}
+
+void PresetBank::read(const void* data, size_t sizeInBytes)
+{
+  clear();
+
+  const auto* bytes = static_cast<const char*>(data);
+  const auto headerSize = 2 * sizeof(juce::uint32);
+
+  if (data == nullptr || sizeInBytes < headerSize || juce::ByteOrder::littleEndianInt(bytes) != Magic)
+    return;
+
+  const auto size = juce::jmin(static_cast<size_t>(juce::ByteOrder::littleEndianInt(bytes + sizeof(juce::uint32))),
+                               sizeInBytes - headerSize);
+  const auto* end = bytes + headerSize + size;
+
+  // A truncated or unreadable preset ends the list; the ones before it stay.
+  for (auto* preset = bytes + headerSize; end - preset >= static_cast<std::ptrdiff_t>(sizeof(juce::uint32));) {
+    const auto nameSize = static_cast<size_t>(juce::ByteOrder::littleEndianInt(preset));
+    const auto* state = preset + sizeof(juce::uint32) + nameSize;
+
+    if (nameSize > static_cast<size_t>(end - preset) - sizeof(juce::uint32))
+      break;
+
+    const auto stateSize = static_cast<int>(end - state);
+
+    if (add(juce::String::fromUTF8(preset + sizeof(juce::uint32), static_cast<int>(nameSize)), state, stateSize) < 0)
+      break;
+
+    preset = state + ParameterState::getSizeInBytes(state);
+  }
+}
+
+void PresetBank::clear()
+{
+  m_presets.resize(static_cast<size_t>(m_numFactoryPresets));
+
+  if (m_currentIndex >= m_numFactoryPresets)
+    m_currentIndex = -1;
+}
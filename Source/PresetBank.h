@@ -0,0 +1,58 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ParameterState.h"
+
+// In-memory presets, exposed to hosts as the plugin's programs and picked
+// from the editor's preset bar. The bank is only touched on the message
+// thread: selecting a preset writes the same parameter atomics the audio
+// thread already reads, so the audio thread never waits on it. Continuous
+// parameters then glide on their smoothers and the processor crossfades
+// across discrete ones. The factory presets always come first; user
+// presets follow them and are saved with the plugin state.
+class PresetBank
+{
+public:
+  explicit PresetBank(const ParameterState& state);
+
+  // Both return the new preset's index, or -1 if data is not a binary state.
+  // A preset made from the current values becomes the current one.
+  int addCurrent(const juce::String& name);
+  int add(const juce::String& name, const void* data, int sizeInBytes);
+
+  bool select(int index);
+  void rename(int index, const juce::String& name);
+
+  int getNumPresets() const { return static_cast<int>(m_presets.size()); }
+  int getNumFactoryPresets() const { return m_numFactoryPresets; }
+  int getCurrentIndex() const { return m_currentIndex; }
+  juce::String getName(int index) const;
+  // Normalised values in parameter order, as select() applies them.
+  const std::vector<float>& getValues(int index) const;
+
+  // The user presets, appended to the plugin state after the cabinet:
+  //   uint32 magic, uint32 byte count,
+  //   per preset { uint32 name byte count, UTF-8 name, binary ParameterState }
+  void write(juce::MemoryBlock& dest) const;
+  // Replaces the user presets with the stored ones, or drops them if data
+  // does not start with a preset chunk.
+  void read(const void* data, size_t sizeInBytes);
+  void clear();
+
+private:
+  static constexpr juce::uint32 Magic = 0x504b5853; // "SXKP"
+
+  struct Preset
+  {
+    juce::String name;
+    std::vector<float> values;
+  };
+
+  void addFactoryPresets();
+
+  const ParameterState& m_state;
+  std::vector<Preset> m_presets;
+  int m_numFactoryPresets = 0;
+  int m_currentIndex = -1;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
@@ -0,0 +1,37 @@
+#include "Quality.h"
+
+void AutoQuality::prepare(double sampleRate)
+{
+  m_sampleRate = sampleRate;
+  reset();
+}
+
+void AutoQuality::reset()
+{
+  m_peakLoad = 0.f;
+  m_samplesSinceStep = 0;
+  m_level = Quality::high;
+}
+
+void AutoQuality::update(float load, int numSamples)
+{
+  const auto release = std::exp(-numSamples / (ReleaseSeconds * m_sampleRate));
+  m_peakLoad = juce::jmax(load, m_peakLoad * static_cast<float>(release));
+  m_samplesSinceStep += numSamples;
+
+  if (m_samplesSinceStep < static_cast<juce::int64>(SettleSeconds * m_sampleRate))
+    return;
+
+  if (m_peakLoad > StepDownLoad && m_level > Quality::eco)
+    step(-1);
+  else if (m_peakLoad < StepUpLoad && m_level < Quality::high
+           && m_samplesSinceStep >= static_cast<juce::int64>(StepUpSeconds * m_sampleRate))
+    step(1);
+}
+
+void AutoQuality::step(int direction)
+{
+  m_level = static_cast<Quality::Level>(m_level + direction);
+  m_peakLoad = 0.f;
+  m_samplesSinceStep = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Processing quality. Levels trade the order of the plain soft clip curve
+// and how exactly the filter follows a moving cutoff or Q. None of them
+// touches oversampling or ADAA, so switching never changes the latency.
+struct Quality
+{
+  enum Level
+  {
+    eco = 0,
+    normal,
+    high,
+    NumLevels
+  };
+
+  // The parameter's choice after the levels; AutoQuality picks the level.
+  static constexpr int automatic = NumLevels;
+
+  // How long the stages blend from the old level's curves to the new ones.
+  static constexpr double blendSeconds = 0.005;
+};
+
+// Picks the level for the Auto setting from the fraction of the buffer
+// deadline each block took. The load is followed with an instant attack so
+// a single spike counts; the level steps down as soon as that crosses
+// StepDownLoad and only climbs back after a long quiet spell, so it does
+// not hunt. Audio thread only.
+class AutoQuality
+{
+public:
+  void prepare(double sampleRate);
+  // Starts over at the top level.
+  void reset();
+  void update(float load, int numSamples);
+
+  Quality::Level getLevel() const { return m_level; }
+
+private:
+  static constexpr float StepDownLoad = 0.6f;
+  static constexpr float StepUpLoad = 0.25f;
+  static constexpr double ReleaseSeconds = 0.5;
+  // Lets the load settle at the new level before judging it again.
+  static constexpr double SettleSeconds = 0.25;
+  static constexpr double StepUpSeconds = 5.0;
+
+  void step(int direction);
+
+  double m_sampleRate = 44100.0;
+  float m_peakLoad = 0.f;
+  juce::int64 m_samplesSinceStep = 0;
+  Quality::Level m_level = Quality::high;
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Small set of helpers that let DSP kernels be written once and instantiated
+// for plain scalars as well as juce::dsp::SIMDRegister lanes.
+
+template <typename T>
+struct IsSIMDRegister : std::false_type {};
+
+template <typename T>
+struct IsSIMDRegister<juce::dsp::SIMDRegister<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool isSIMDRegister = IsSIMDRegister<T>::value;
+
+template <typename T>
+struct SIMDElement { using Type = T; };
+
+template <typename T>
+struct SIMDElement<juce::dsp::SIMDRegister<T>> { using Type = T; };
+
+template <typename T>
+using SIMDElementType = typename SIMDElement<T>::Type;
+
+template <typename T>
+inline T simdBroadcast(double value) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return T::expand(static_cast<typename T::ElementType>(value));
+  else
+    return static_cast<T>(value);
+}
+
+template <typename T>
+inline T simdMin(T a, T b) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return T::min(a, b);
+  else
+    return std::min(a, b);
+}
+
+template <typename T>
+inline T simdMax(T a, T b) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return T::max(a, b);
+  else
+    return std::max(a, b);
+}
+
+template <typename T>
+inline T simdClamp(T value, double low, double high) noexcept
+{
+  return simdMin(simdMax(value, simdBroadcast<T>(low)), simdBroadcast<T>(high));
+}
+
+template <typename T>
+inline T simdAbs(T value) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return T::max(value, T::expand(0) - value);
+  else
+    return std::abs(value);
+}
+
+template <typename T>
+inline auto simdLessThan(T a, T b) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return T::lessThan(a, b);
+  else
+    return a < b;
+}
+
+// Picks a where the mask is set and b elsewhere, without branching per lane.
+template <typename Mask, typename T>
+inline T simdSelect(Mask mask, T a, T b) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return (a & mask) + (b & ~mask);
+  else
+    return mask ? a : b;
+}
+
+template <typename Mask>
+inline bool simdAny(Mask mask) noexcept
+{
+  if constexpr (isSIMDRegister<Mask>)
+    return mask.sum() != 0;
+  else
+    return mask;
+}
+
+// For maths that has no vector form (log, atan, ...).
+template <typename T, typename Function>
+inline T simdPerLane(T value, Function&& function)
+{
+  if constexpr (isSIMDRegister<T>) {
+    for (size_t i = 0; i < T::SIMDNumElements; ++i)
+      value.set(i, function(value.get(i)));
+
+    return value;
+  } else {
+    return function(value);
+  }
+}
+
+// juce::dsp::SIMDRegister has no division operator, so map it onto the
+// native instruction where one exists and fall back to per-lane division.
+template <typename T>
+inline T simdDivide(T a, T b) noexcept
+{
+  if constexpr (! isSIMDRegister<T>) {
+    return a / b;
+  } else {
+    using Native = typename T::vSIMDType;
+
+#if JUCE_USE_SSE_INTRINSICS
+    if constexpr (std::is_same_v<Native, __m128>)
+      return T::fromNative(_mm_div_ps(a.value, b.value));
+    else if constexpr (std::is_same_v<Native, __m128d>)
+      return T::fromNative(_mm_div_pd(a.value, b.value));
+    else
+#elif JUCE_USE_ARM_NEON && defined(__aarch64__)
+    if constexpr (std::is_same_v<Native, float32x4_t>)
+      return T::fromNative(vdivq_f32(a.value, b.value));
+    else
+#endif
+    {
+      auto result = T::expand(0);
+
+      for (size_t i = 0; i < T::SIMDNumElements; ++i)
+        result.set(i, a.get(i) / b.get(i));
+
+      return result;
+    }
+  }
+}
+
+template <typename T, typename ElementType>
+inline T simdLoad(const ElementType* data) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    return T::fromRawArray(data);
+  else
+    return *data;
+}
+
+template <typename T, typename ElementType>
+inline void simdStore(T value, ElementType* data) noexcept
+{
+  if constexpr (isSIMDRegister<T>)
+    value.copyToRawArray(data);
+  else
+    *data = value;
+}
+
+// Runs function(index, T{}) over SIMD-aligned arrays: whole registers first,
+// then a scalar tail. The second argument only carries the lane type.
+template <typename ElementType, typename Function>
+inline void simdForEach(int numSamples, Function&& function)
+{
+  using Register = juce::dsp::SIMDRegister<ElementType>;
+  constexpr auto step = static_cast<int>(Register::SIMDNumElements);
+
+  int i = 0;
+
+  for (; i + step <= numSamples; i += step)
+    function(i, Register::expand(0));
+
+  for (; i < numSamples; ++i)
+    function(i, ElementType(0));
+}
@@ -1,61 +1,158 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
 
-template <size_t BlockSize, int NumBlocks>
+// Single-producer/single-consumer hand-off of fixed-size scope blocks from
+// the audio thread to the GUI. The writer fills ring slots in place with
+// bulk copies; the reader skips straight to the newest completed block and
+// reads it where it lies, so stale blocks are never copied.
+template <size_t BlockSize, int NumBlocks, int NumChannels = 2>
 class ScopeDataQueue
 {
 public:
+  struct Block
+  {
+    std::array<std::array<float, BlockSize>, NumChannels> channels;
+    int numChannels = 0;
+    juce::uint64 frame = 0;
+  };
+
   ScopeDataQueue() = default;
 
-  void push(const float* data, size_t numSamples)
+  // Audio thread. Double-precision blocks are narrowed to float on the way in.
+  template <typename SampleType>
+  void push(const juce::dsp::AudioBlock<SampleType>& block)
   {
-    for (size_t i = 0; i < numSamples; ++i) {
-      currentBlock[sampleIndex++] = data[i];
-      if (sampleIndex == BlockSize) {
-        int start1, size1, start2, size2;
-        fifo.prepareToWrite(1, start1, size1, start2, size2);
+    const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), NumChannels);
+    const auto numSamples = block.getNumSamples();
+    size_t position = 0;
+
+    while (position < numSamples) {
+      if (m_sampleIndex == 0)
+        beginBlock(numChannels);
 
-        if (size1 > 0) {
-          std::copy(currentBlock.begin(),
-                    currentBlock.end(),
-                    blocks[static_cast<size_t>(start1)].begin());
-        }
+      const auto count = juce::jmin(numSamples - position, BlockSize - m_sampleIndex);
 
-        fifo.finishedWrite(size1 + size2);
-        sampleIndex = 0;
+      for (int ch = 0; ch < numChannels; ++ch) {
+        auto* dest = m_writeBlock->channels[static_cast<size_t>(ch)].data() + m_sampleIndex;
+        const auto* source = block.getChannelPointer(static_cast<size_t>(ch)) + position;
+
+        if constexpr (std::is_same_v<std::remove_const_t<SampleType>, float>)
+          std::memcpy(dest, source, count * sizeof(float));
+        else
+          std::transform(source, source + count, dest,
+                         [](auto sample) { return static_cast<float>(sample); });
       }
+
+      m_sampleIndex += count;
+      position += count;
+
+      if (m_sampleIndex == BlockSize)
+        endBlock();
     }
   }
 
-  bool pull(std::array<float, BlockSize>& outBlock)
+  // Consumer thread. Returns the newest complete block, discarding any older
+  // ones unread, or nullptr if nothing has arrived since the last call. The
+  // block stays valid until the next call.
+  const Block* readLatest()
   {
-    bool hasNewData = false;
+    releaseHeldBlock();
+    const auto numReady = m_fifo.getNumReady();
 
-    int numReady = fifo.getNumReady();
+    if (numReady == 0)
+      return nullptr;
 
-    while (numReady > 0) {
-      int start1, size1, start2, size2;
-      fifo.prepareToRead(1, start1, size1, start2, size2);
+    m_fifo.finishedRead(numReady - 1);
+    return holdNextBlock();
+  }
 
-      if (size1 > 0) {
-        std::copy(blocks[static_cast<size_t>(start1)].begin(),
-                  blocks[static_cast<size_t>(start1)].end(),
-                  outBlock.begin());
-        hasNewData = true;
-      }
+  // Consumer thread. Like readLatest(), but returns the oldest queued block
+  // for readers that need a contiguous stream; gaps show up in the frame
+  // numbers.
+  const Block* readNext()
+  {
+    releaseHeldBlock();
+    return m_fifo.getNumReady() > 0 ? holdNextBlock() : nullptr;
+  }
 
-      fifo.finishedRead(size1 + size2);
-      numReady = fifo.getNumReady();
-    }
+  // Empties the queue and restarts the frame count. Only while neither the
+  // writer nor the reader is using it, e.g. before handing it to new ones.
+  void reset()
+  {
+    m_fifo.reset();
+    m_writeBlock = nullptr;
+    m_sampleIndex = 0;
+    m_nextFrame = 0;
+    m_numDropped.store(0, std::memory_order_relaxed);
+    m_holdingBlock = false;
+  }
 
-    return hasNewData;
+  // Blocks the writer had to throw away because every slot was still queued
+  // or held by the reader.
+  juce::uint64 getNumDroppedBlocks() const
+  {
+    return m_numDropped.load(std::memory_order_relaxed);
   }
 
 private:
-  juce::AbstractFifo fifo{ NumBlocks };
-  std::array<std::array<float, BlockSize>, NumBlocks> blocks;
-  std::array<float, BlockSize> currentBlock;
-  size_t sampleIndex = 0;
+  void releaseHeldBlock()
+  {
+    if (m_holdingBlock) {
+      m_fifo.finishedRead(1);
+      m_holdingBlock = false;
+    }
+  }
+
+  const Block* holdNextBlock()
+  {
+    int start1, size1, start2, size2;
+    m_fifo.prepareToRead(1, start1, size1, start2, size2);
+    jassert(size1 == 1);
+
+    m_holdingBlock = true;
+    return &m_blocks[static_cast<size_t>(start1)];
+  }
+
+  void beginBlock(int numChannels)
+  {
+    m_writeBlock = &m_overflowBlock;
+
+    if (m_fifo.getFreeSpace() > 0) {
+      int start1, size1, start2, size2;
+      m_fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+      if (size1 > 0)
+        m_writeBlock = &m_blocks[static_cast<size_t>(start1)];
+    }
+
+    m_writeBlock->numChannels = numChannels;
+    m_writeBlock->frame = m_nextFrame++;
+  }
+
+  void endBlock()
+  {
+    if (m_writeBlock == &m_overflowBlock)
+      m_numDropped.fetch_add(1, std::memory_order_relaxed);
+    else
+      m_fifo.finishedWrite(1);
+
+    m_sampleIndex = 0;
+  }
+
+  juce::AbstractFifo m_fifo{ NumBlocks };
+  std::array<Block, NumBlocks> m_blocks;
+  Block m_overflowBlock;
+
+  Block* m_writeBlock = nullptr;
+  size_t m_sampleIndex = 0;
+  juce::uint64 m_nextFrame = 0;
+  std::atomic<juce::uint64> m_numDropped{ 0 };
+
+  bool m_holdingBlock = false;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeDataQueue)
 };
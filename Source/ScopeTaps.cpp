@@ -0,0 +1,59 @@
+#include "ScopeTaps.h"
+
+void ScopeTaps::reset()
+{
+  scope.reset();
+  analyzerInput.reset();
+  analyzerOutput.reset();
+}
+
+std::unique_ptr<ScopeTaps> ScopeTapPool::take()
+{
+  if (m_idle.empty())
+    return std::make_unique<ScopeTaps>();
+
+  auto taps = std::move(m_idle.back());
+  m_idle.pop_back();
+  return taps;
+}
+
+void ScopeTapPool::recycle(std::unique_ptr<ScopeTaps> taps)
+{
+  if (m_idle.size() < MaxIdleTaps)
+    m_idle.push_back(std::move(taps));
+}
+
+ScopeTapSlot::~ScopeTapSlot()
+{
+  // An editor must not outlive its processor.
+  jassert(m_owned == nullptr);
+}
+
+ScopeTapSlot::Lease::Lease(ScopeTapSlot& slot) : m_slot(slot), m_taps(slot.attach()) {}
+
+ScopeTapSlot::Lease::~Lease()
+{
+  m_slot.detach();
+}
+
+ScopeTaps* ScopeTapSlot::attach()
+{
+  // The queues are single-consumer, so only one editor can read them.
+  jassert(m_owned == nullptr);
+
+  m_owned = m_pool->take();
+  m_owned->reset();
+  m_published.store(m_owned.get());
+  return m_owned.get();
+}
+
+void ScopeTapSlot::detach()
+{
+  m_published.store(nullptr);
+
+  // At most one audio callback's worth of pushes.
+  while (m_inUse.load())
+    juce::Thread::yield();
+
+  m_pool->recycle(std::move(m_owned));
+}
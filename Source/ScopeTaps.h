@@ -0,0 +1,102 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ScopeDataQueue.h"
+#include "SpectrumAnalyzer.h"
+
+inline constexpr size_t ScopeBlockSize = 1024;
+inline constexpr int ScopeNumBlocks = 8;
+
+using ScopeQueue = ScopeDataQueue<ScopeBlockSize, ScopeNumBlocks>;
+
+// Everything the editor's oscilloscope and spectrum analyzer read from,
+// roughly 350 KB per set. Only processors with an open editor hold one.
+struct ScopeTaps
+{
+  ScopeQueue scope;
+  AnalyzerQueue analyzerInput;
+  AnalyzerQueue analyzerOutput;
+
+  void reset();
+};
+
+// Idle ScopeTaps shared by every Skux instance in the process, so closing
+// one editor and opening another reuses the memory instead of reallocating
+// it. Message thread only.
+class ScopeTapPool
+{
+public:
+  std::unique_ptr<ScopeTaps> take();
+  void recycle(std::unique_ptr<ScopeTaps> taps);
+
+private:
+  // Enough to cover a few editors being swapped; the rest are freed.
+  static constexpr size_t MaxIdleTaps = 2;
+
+  std::vector<std::unique_ptr<ScopeTaps>> m_idle;
+};
+
+// A processor's link to the taps of its open editor, if any. The editor
+// holds a Lease for as long as its displays exist; the audio thread reads
+// the slot through ScopedAccess and skips every push while it is empty, so
+// headless and offline renders neither allocate nor write scope memory.
+class ScopeTapSlot
+{
+public:
+  ScopeTapSlot() = default;
+  ~ScopeTapSlot();
+
+  // Message thread. Leases a reset set of taps from the shared pool and
+  // publishes it to the audio thread until the lease ends.
+  class Lease
+  {
+  public:
+    explicit Lease(ScopeTapSlot& slot);
+    ~Lease();
+
+    ScopeTaps& operator*() const { return *m_taps; }
+    ScopeTaps* operator->() const { return m_taps; }
+
+  private:
+    ScopeTapSlot& m_slot;
+    ScopeTaps* m_taps;
+
+    JUCE_DECLARE_NON_COPYABLE(Lease)
+  };
+
+  // Audio thread. Pins the published taps, if any, for its lifetime; a
+  // lease ending meanwhile waits for it rather than pulling them away.
+  class ScopedAccess
+  {
+  public:
+    explicit ScopedAccess(ScopeTapSlot& slot) : m_slot(slot)
+    {
+      m_slot.m_inUse.store(true);
+      m_taps = m_slot.m_published.load();
+    }
+
+    ~ScopedAccess() { m_slot.m_inUse.store(false); }
+
+    explicit operator bool() const { return m_taps != nullptr; }
+    ScopeTaps* operator->() const { return m_taps; }
+
+  private:
+    ScopeTapSlot& m_slot;
+    ScopeTaps* m_taps;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAccess)
+  };
+
+private:
+  ScopeTaps* attach();
+  void detach();
+
+  juce::SharedResourcePointer<ScopeTapPool> m_pool;
+  std::unique_ptr<ScopeTaps> m_owned;
+
+  // Sequentially consistent, so detach() either sees the audio thread still
+  // holding the taps or the audio thread sees them already gone.
+  std::atomic<ScopeTaps*> m_published{ nullptr };
+  std::atomic<bool> m_inUse{ false };
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeTapSlot)
+};
@@ -0,0 +1,179 @@
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer(AnalyzerQueue& inputQueue, AnalyzerQueue& outputQueue)
+    : juce::Thread("Skux Spectrum Analyzer"), m_inputQueue(inputQueue), m_outputQueue(outputQueue)
+{
+  startThread(juce::Thread::Priority::low);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+  stopThread(1000);
+}
+
+void SpectrumAnalyzer::setSettings(const Settings& settings)
+{
+  const juce::ScopedLock lock(m_settingsLock);
+  m_pendingSettings = settings;
+  m_settingsChanged = true;
+}
+
+SpectrumAnalyzer::Settings SpectrumAnalyzer::getSettings() const
+{
+  const juce::ScopedLock lock(m_settingsLock);
+  return m_pendingSettings;
+}
+
+void SpectrumAnalyzer::copySpectrum(Trace trace, std::vector<float>& decibels) const
+{
+  const juce::ScopedLock lock(m_spectrumLock);
+  decibels = m_spectra[static_cast<size_t>(trace)];
+}
+
+void SpectrumAnalyzer::run()
+{
+  const AnalyzerQueue::Block* inputBlock = nullptr;
+  const AnalyzerQueue::Block* outputBlock = nullptr;
+
+  while (! threadShouldExit()) {
+    {
+      const juce::ScopedLock lock(m_settingsLock);
+
+      if (m_settingsChanged) {
+        applySettings(m_pendingSettings);
+        m_settingsChanged = false;
+      }
+    }
+
+    if (inputBlock == nullptr)
+      inputBlock = m_inputQueue.readNext();
+
+    if (outputBlock == nullptr)
+      outputBlock = m_outputQueue.readNext();
+
+    if (inputBlock == nullptr || outputBlock == nullptr) {
+      wait(IdleWaitMs);
+      continue;
+    }
+
+    // Both taps see the same samples, so their frame numbers only differ
+    // when one queue dropped a block; skip ahead on the side that is behind.
+    if (inputBlock->frame != outputBlock->frame) {
+      if (inputBlock->frame < outputBlock->frame)
+        inputBlock = nullptr;
+      else
+        outputBlock = nullptr;
+
+      continue;
+    }
+
+    if (inputBlock->frame != m_nextFrame)
+      restartStream();
+
+    const auto analyzed = pushBlock(m_traces[input], *inputBlock);
+    pushBlock(m_traces[output], *outputBlock);
+    m_nextFrame = inputBlock->frame + 1;
+
+    if (analyzed)
+      publish();
+
+    inputBlock = nullptr;
+    outputBlock = nullptr;
+  }
+}
+
+void SpectrumAnalyzer::applySettings(const Settings& settings)
+{
+  m_settings = settings;
+  m_settings.fftOrder = juce::jlimit(8, 14, settings.fftOrder);
+  m_settings.overlap = juce::jlimit(1, 16, settings.overlap);
+  m_settings.averaging = juce::jlimit(0.f, 0.99f, settings.averaging);
+
+  const auto fftSize = size_t(1) << m_settings.fftOrder;
+  m_fft = std::make_unique<juce::dsp::FFT>(m_settings.fftOrder);
+  m_window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, m_settings.window, true);
+  m_hopSize = juce::jmax(size_t(1), fftSize / static_cast<size_t>(m_settings.overlap));
+
+  for (auto& state : m_traces) {
+    state.fifo.assign(fftSize, 0.f);
+    state.fftData.assign(fftSize * 2, 0.f);
+    state.power.assign(fftSize / 2 + 1, 0.f);
+    state.fifoFill = 0;
+  }
+
+  const juce::ScopedLock lock(m_spectrumLock);
+
+  for (auto& spectrum : m_spectra)
+    spectrum.assign(fftSize / 2 + 1, MinDecibels);
+}
+
+void SpectrumAnalyzer::restartStream()
+{
+  // A gap in the stream: frames straddling it would smear, so start over.
+  for (auto& state : m_traces)
+    state.fifoFill = 0;
+}
+
+bool SpectrumAnalyzer::pushBlock(TraceState& state, const AnalyzerQueue::Block& block)
+{
+  const auto fftSize = state.fifo.size();
+  const auto numChannels = static_cast<size_t>(juce::jmax(1, block.numChannels));
+  const auto channelGain = 1.f / static_cast<float>(numChannels);
+  auto analyzed = false;
+
+  for (size_t i = 0; i < AnalyzerBlockSize; ++i) {
+    auto sample = 0.f;
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+      sample += block.channels[ch][i];
+
+    state.fifo[state.fifoFill++] = sample * channelGain;
+
+    if (state.fifoFill == fftSize) {
+      analyzeFrame(state);
+      std::copy(state.fifo.begin() + static_cast<std::ptrdiff_t>(m_hopSize), state.fifo.end(),
+                state.fifo.begin());
+      state.fifoFill -= m_hopSize;
+      analyzed = true;
+    }
+  }
+
+  return analyzed;
+}
+
+void SpectrumAnalyzer::analyzeFrame(TraceState& state)
+{
+  const auto fftSize = state.fifo.size();
+
+  std::copy(state.fifo.begin(), state.fifo.end(), state.fftData.begin());
+  std::fill(state.fftData.begin() + static_cast<std::ptrdiff_t>(fftSize), state.fftData.end(), 0.f);
+
+  m_window->multiplyWithWindowingTable(state.fftData.data(), fftSize);
+  m_fft->performFrequencyOnlyForwardTransform(state.fftData.data(), true);
+
+  // A full-scale sine reads 0 dB.
+  const auto scale = 2.f / static_cast<float>(fftSize);
+  const auto averaging = m_settings.averaging;
+
+  for (size_t bin = 0; bin < state.power.size(); ++bin) {
+    const auto magnitude = state.fftData[bin] * scale;
+    state.power[bin] = averaging * state.power[bin] + (1.f - averaging) * magnitude * magnitude;
+  }
+}
+
+void SpectrumAnalyzer::publish()
+{
+  {
+    const juce::ScopedLock lock(m_spectrumLock);
+
+    for (size_t trace = 0; trace < NumTraces; ++trace) {
+      const auto& power = m_traces[trace].power;
+      auto& spectrum = m_spectra[trace];
+
+      for (size_t bin = 0; bin < power.size(); ++bin)
+        spectrum[bin] = juce::jmax(MinDecibels, 10.f * std::log10(power[bin] + 1.0e-12f));
+    }
+  }
+
+  m_version.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ScopeDataQueue.h"
+
+inline constexpr size_t AnalyzerBlockSize = 512;
+inline constexpr int AnalyzerNumBlocks = 32;
+
+using AnalyzerQueue = ScopeDataQueue<AnalyzerBlockSize, AnalyzerNumBlocks>;
+
+// Compares the signal going into the distortion with the plugin output.
+// The processor pushes both into AnalyzerQueues; this reads them in step on
+// its own thread, so the FFTs never run on the audio or message thread. The
+// thread lives as long as the analyzer, which the editor owns.
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+  enum Trace
+  {
+    input = 0,
+    output,
+    NumTraces
+  };
+
+  struct Settings
+  {
+    int fftOrder = 11;
+    juce::dsp::WindowingFunction<float>::WindowingMethod window
+      = juce::dsp::WindowingFunction<float>::hann;
+    int overlap = 4;
+    // Weight of the previous frame in the running power average, 0 to < 1.
+    float averaging = 0.8f;
+  };
+
+  static constexpr float MinDecibels = -100.f;
+
+  SpectrumAnalyzer(AnalyzerQueue& inputQueue, AnalyzerQueue& outputQueue);
+  ~SpectrumAnalyzer() override;
+
+  // Any thread; the analysis thread picks the change up before its next frame.
+  void setSettings(const Settings& settings);
+  Settings getSettings() const;
+
+  // Bumped whenever a new frame has been analyzed.
+  juce::uint32 getVersion() const { return m_version.load(std::memory_order_acquire); }
+
+  // Copies the averaged spectrum in dB, one value per bin from DC to Nyquist.
+  void copySpectrum(Trace trace, std::vector<float>& decibels) const;
+
+private:
+  struct TraceState
+  {
+    std::vector<float> fifo;
+    std::vector<float> fftData;
+    std::vector<float> power;
+    size_t fifoFill = 0;
+  };
+
+  static constexpr int IdleWaitMs = 10;
+
+  void run() override;
+  void applySettings(const Settings& settings);
+  void restartStream();
+  bool pushBlock(TraceState& state, const AnalyzerQueue::Block& block);
+  void analyzeFrame(TraceState& state);
+  void publish();
+
+  AnalyzerQueue& m_inputQueue;
+  AnalyzerQueue& m_outputQueue;
+
+  mutable juce::CriticalSection m_settingsLock;
+  Settings m_pendingSettings;
+  bool m_settingsChanged = true;
+
+  // Owned by the analysis thread.
+  Settings m_settings;
+  std::unique_ptr<juce::dsp::FFT> m_fft;
+  std::unique_ptr<juce::dsp::WindowingFunction<float>> m_window;
+  std::array<TraceState, NumTraces> m_traces;
+  size_t m_hopSize = 0;
+  juce::uint64 m_nextFrame = 0;
+
+  mutable juce::CriticalSection m_spectrumLock;
+  std::array<std::vector<float>, NumTraces> m_spectra;
+  std::atomic<juce::uint32> m_version{ 0 };
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+
+// Draws the analyzer's input and output spectra on a log frequency axis.
+// Owns the analyzer, so its thread only runs while the editor is open.
+class SpectrumDisplay : public juce::Component, private juce::Timer
+{
+public:
+  SpectrumDisplay(AnalyzerQueue& inputQueue, AnalyzerQueue& outputQueue,
+                  const juce::AudioProcessor& processor)
+      : m_analyzer(inputQueue, outputQueue), m_processor(processor)
+  {
+    startTimerHz(30);
+  }
+
+  SpectrumAnalyzer& getAnalyzer() { return m_analyzer; }
+
+  void paint(juce::Graphics& g) override
+  {
+    auto bounds = getLocalBounds().toFloat();
+
+    g.fillAll(juce::Colour(0xff1a1a2e));
+
+    g.setColour(juce::Colours::white.withAlpha(0.1f));
+    g.drawRect(bounds, 1.f);
+
+    g.setColour(juce::Colours::white.withAlpha(0.06f));
+    for (const auto frequency : { 100.f, 1000.f, 10000.f }) {
+      const auto x = bounds.getX() + bounds.getWidth() * frequencyToProportion(frequency);
+      g.drawVerticalLine(static_cast<int>(x), bounds.getY(), bounds.getBottom());
+    }
+
+    const auto sampleRate = m_processor.getSampleRate();
+
+    if (sampleRate <= 0.0 || m_spectra[0].size() < 2)
+      return;
+
+    const auto inputPath = makePath(m_spectra[SpectrumAnalyzer::input], bounds, sampleRate);
+    const auto outputPath = makePath(m_spectra[SpectrumAnalyzer::output], bounds, sampleRate);
+
+    g.setColour(juce::Colours::white.withAlpha(0.35f));
+    g.strokePath(inputPath, juce::PathStrokeType(1.f));
+
+    g.setColour(juce::Colour(0xff00e5ff));
+    g.strokePath(outputPath, juce::PathStrokeType(1.5f));
+  }
+
+private:
+  static constexpr float MinFrequency = 20.f;
+  static constexpr float MaxFrequency = 20000.f;
+  static constexpr float MinDisplayDecibels = -90.f;
+  static constexpr float MaxDisplayDecibels = 6.f;
+
+  void timerCallback() override
+  {
+    const auto version = m_analyzer.getVersion();
+
+    if (version == m_lastVersion)
+      return;
+
+    m_lastVersion = version;
+
+    for (int trace = 0; trace < SpectrumAnalyzer::NumTraces; ++trace)
+      m_analyzer.copySpectrum(static_cast<SpectrumAnalyzer::Trace>(trace),
+                              m_spectra[static_cast<size_t>(trace)]);
+
+    repaint();
+  }
+
+  static float frequencyToProportion(float frequency)
+  {
+    return std::log(frequency / MinFrequency) / std::log(MaxFrequency / MinFrequency);
+  }
+
+  // One point per pixel column, taking the loudest bin the column covers so
+  // narrow peaks at the top of the range are not lost.
+  static juce::Path makePath(const std::vector<float>& decibels, juce::Rectangle<float> bounds,
+                             double sampleRate)
+  {
+    juce::Path path;
+    const auto width = juce::jmax(1, static_cast<int>(bounds.getWidth()));
+    const auto binsPerHz = static_cast<float>(2 * (decibels.size() - 1) / sampleRate);
+    const auto lastBin = static_cast<int>(decibels.size()) - 1;
+
+    for (int x = 0; x < width; ++x) {
+      const auto proportion = static_cast<float>(x) / static_cast<float>(width);
+      const auto nextProportion = static_cast<float>(x + 1) / static_cast<float>(width);
+      const auto low = MinFrequency * std::pow(MaxFrequency / MinFrequency, proportion);
+      const auto high = MinFrequency * std::pow(MaxFrequency / MinFrequency, nextProportion);
+      const auto firstBin = juce::jlimit(0, lastBin, static_cast<int>(low * binsPerHz));
+      const auto endBin = juce::jlimit(firstBin, lastBin, static_cast<int>(high * binsPerHz));
+
+      auto level = decibels[static_cast<size_t>(firstBin)];
+      for (auto bin = firstBin + 1; bin <= endBin; ++bin)
+        level = juce::jmax(level, decibels[static_cast<size_t>(bin)]);
+
+      const auto y = juce::jmap(juce::jlimit(MinDisplayDecibels, MaxDisplayDecibels, level),
+                                MinDisplayDecibels, MaxDisplayDecibels,
+                                bounds.getBottom(), bounds.getY());
+      const auto px = bounds.getX() + static_cast<float>(x);
+
+      if (x == 0)
+        path.startNewSubPath(px, y);
+      else
+        path.lineTo(px, y);
+    }
+
+    return path;
+  }
+
+  SpectrumAnalyzer m_analyzer;
+  const juce::AudioProcessor& m_processor;
+  std::array<std::vector<float>, SpectrumAnalyzer::NumTraces> m_spectra;
+  juce::uint32 m_lastVersion = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ParameterRamp.h"
+
+// How the distortion and filter treat a channel pair. In the mid/side modes
+// the stages encode and decode the pair inside their own per-sample loops;
+// the regular ramps then drive the mid channel and the side ramps here the
+// side one, while Mid Only and Side Only leave the other channel dry.
+struct StereoParameters
+{
+  enum Mode
+  {
+    stereo = 0,
+    midSide,
+    midOnly,
+    sideOnly
+  };
+
+  int mode = stereo;
+  ParameterRamp sideDrive, sideMix, sideCutoff;
+
+  bool isMidSide() const { return mode != stereo; }
+
+  ParameterRamp getMidMix(const ParameterRamp& mix) const
+  {
+    return mode == sideOnly ? ParameterRamp{} : mix;
+  }
+
+  ParameterRamp getSideMix() const
+  {
+    return mode == midOnly ? ParameterRamp{} : sideMix;
+  }
+};
@@ -0,0 +1,154 @@
+#include "TraceRecorder.h"
+
+TraceRecorder::TraceRecorder() : juce::Thread("Skux Trace Writer")
+{
+  m_microsecondsPerTick = 1.0e6 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+}
+
+TraceRecorder::~TraceRecorder()
+{
+  stop();
+}
+
+juce::File TraceRecorder::getDefaultFile()
+{
+  return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+    .getChildFile("Skux")
+    .getChildFile("Traces")
+    .getChildFile("skux-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+}
+
+bool TraceRecorder::start(const juce::File& file)
+{
+  stop();
+
+  file.getParentDirectory().createDirectory();
+  auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+  if (stream->failedToOpen() || ! stream->setPosition(0) || stream->truncate().failed())
+    return false;
+
+  // Allocated once and kept, so a late write from a capture that has just
+  // stopped never lands in freed memory.
+  if (m_events.empty())
+    m_events.resize(Capacity);
+
+  m_file = file;
+  m_stream = std::move(stream);
+  m_firstEvent = true;
+  m_threadIds.clear();
+  m_numDropped.store(0, std::memory_order_relaxed);
+  m_startTicks = juce::Time::getHighResolutionTicks();
+
+  *m_stream << "{\"traceEvents\":[\n";
+
+  m_readPosition.store(m_writePosition.load(std::memory_order_acquire), std::memory_order_relaxed);
+  m_recording.store(true, std::memory_order_release);
+  startThread(juce::Thread::Priority::low);
+  return true;
+}
+
+void TraceRecorder::stop()
+{
+  if (! m_recording.exchange(false, std::memory_order_acq_rel))
+    return;
+
+  signalThreadShouldExit();
+  notify();
+  waitForThreadToExit(-1);
+
+  flush();
+  writeFooter();
+  m_stream.reset();
+}
+
+void TraceRecorder::record(DspLoadMonitor::Stage stage, juce::int64 beginTicks, juce::int64 endTicks,
+                           int hostBlockSize)
+{
+  if (! m_recording.load(std::memory_order_acquire))
+    return;
+
+  const auto write = m_writePosition.load(std::memory_order_relaxed);
+
+  if (write - m_readPosition.load(std::memory_order_acquire) >= Capacity) {
+    m_numDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const auto threadId = reinterpret_cast<juce::pointer_sized_uint>(juce::Thread::getCurrentThreadId());
+  m_events[write & (Capacity - 1)] = { beginTicks, endTicks, static_cast<juce::uint64>(threadId),
+                                       hostBlockSize, static_cast<juce::int32>(stage) };
+  m_writePosition.store(write + 1, std::memory_order_release);
+}
+
+void TraceRecorder::run()
+{
+  while (! threadShouldExit()) {
+    wait(FlushIntervalMs);
+    flush();
+  }
+}
+
+void TraceRecorder::flush()
+{
+  const auto write = m_writePosition.load(std::memory_order_acquire);
+  auto read = m_readPosition.load(std::memory_order_relaxed);
+
+  if (read == write)
+    return;
+
+  juce::MemoryOutputStream text;
+
+  for (; read != write; ++read) {
+    const auto event = m_events[read & (Capacity - 1)];
+
+    // Written by a capture that had just stopped.
+    if (event.beginTicks < m_startTicks)
+      continue;
+
+    // Perfetto wants small thread IDs, so the native ones become indices
+    // and are listed by name in the footer.
+    auto thread = std::find(m_threadIds.begin(), m_threadIds.end(), event.threadId);
+    if (thread == m_threadIds.end())
+      thread = m_threadIds.insert(m_threadIds.end(), event.threadId);
+
+    const auto tid = static_cast<int>(thread - m_threadIds.begin()) + 1;
+    const auto ts = static_cast<double>(event.beginTicks - m_startTicks) * m_microsecondsPerTick;
+    const auto dur = static_cast<double>(event.endTicks - event.beginTicks) * m_microsecondsPerTick;
+    const auto name = DspLoadMonitor::getStageName(static_cast<DspLoadMonitor::Stage>(event.stage));
+
+    if (! m_firstEvent)
+      text << ",\n";
+
+    text << "{\"name\":\"" << name << "\",\"cat\":\"dsp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+         << ",\"ts\":" << juce::String(ts, 3) << ",\"dur\":" << juce::String(dur, 3)
+         << ",\"args\":{\"hostBlockSize\":" << event.hostBlockSize << "}}";
+    m_firstEvent = false;
+  }
+
+  m_readPosition.store(read, std::memory_order_release);
+  m_stream->write(text.getData(), text.getDataSize());
+  m_stream->flush();
+}
+
+void TraceRecorder::writeFooter()
+{
+  juce::MemoryOutputStream text;
+
+  if (! m_firstEvent)
+    text << ",\n";
+
+  text << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Skux\"}}";
+
+  for (size_t i = 0; i < m_threadIds.size(); ++i) {
+    text << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << static_cast<int>(i) + 1
+         << ",\"args\":{\"name\":\"Audio 0x" << juce::String::toHexString(static_cast<juce::int64>(m_threadIds[i]))
+         << "\"}}";
+  }
+
+  text << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":"
+       << juce::String(static_cast<juce::int64>(m_numDropped.load(std::memory_order_relaxed))) << "}}\n";
+
+  m_stream->write(text.getData(), text.getDataSize());
+  m_stream->flush();
+}
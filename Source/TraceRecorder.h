@@ -0,0 +1,66 @@
+#pragma once
+#include <JuceHeader.h>
+#include "DspLoadMonitor.h"
+
+// Opt-in capture of every processBlock and stage timing as a Chrome
+// trace-event JSON file, which Perfetto and chrome://tracing load as-is.
+// The audio thread only copies fixed-size events into a ring allocated
+// when the first capture starts; a background thread drains it into the
+// file, so spikes show up individually instead of averaged away.
+class TraceRecorder : private juce::Thread
+{
+public:
+  TraceRecorder();
+  ~TraceRecorder() override;
+
+  // Message thread. Returns false, recording nothing, if the file cannot be
+  // written.
+  bool start(const juce::File& file);
+  void stop();
+  bool isRecording() const { return m_recording.load(std::memory_order_acquire); }
+  juce::File getFile() const { return m_file; }
+
+  // Audio thread. One complete event, named after the load monitor's stage;
+  // dropped if the writer has fallen a whole ring behind.
+  void record(DspLoadMonitor::Stage stage, juce::int64 beginTicks, juce::int64 endTicks,
+              int hostBlockSize);
+
+  // A timestamped file under the user's documents folder.
+  static juce::File getDefaultFile();
+
+private:
+  struct Event
+  {
+    juce::int64 beginTicks;
+    juce::int64 endTicks;
+    juce::uint64 threadId;
+    juce::int32 hostBlockSize;
+    juce::int32 stage;
+  };
+
+  // About 20 s of 64-sample sub-blocks at 48 kHz between flushes.
+  static constexpr size_t Capacity = size_t(1) << 16;
+  static constexpr int FlushIntervalMs = 100;
+
+  void run() override;
+  void flush();
+  void writeFooter();
+
+  // Single producer, single consumer: the audio thread only advances the
+  // write position, the writer thread only the read position.
+  std::vector<Event> m_events;
+  std::atomic<juce::uint64> m_writePosition{ 0 };
+  std::atomic<juce::uint64> m_readPosition{ 0 };
+  std::atomic<juce::uint64> m_numDropped{ 0 };
+  std::atomic<bool> m_recording{ false };
+
+  // Writer thread while recording, message thread otherwise.
+  juce::File m_file;
+  std::unique_ptr<juce::FileOutputStream> m_stream;
+  juce::int64 m_startTicks = 0;
+  double m_microsecondsPerTick = 1.0;
+  bool m_firstEvent = true;
+  std::vector<juce::uint64> m_threadIds;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceRecorder)
+};